@@ -1,8 +1,18 @@
 #pragma once
 
+#include <algorithm>
 #include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
 #include <utility>
 #include <type_traits>
+#include <vector>
 
 // A type that can be implicitly converted to *anything*
 struct Anything {
@@ -57,63 +67,642 @@ template <typename T, std::size_t Cap=32>
 using constructor_arity = detail::maximize< 0, Cap, detail::construct_searcher<T>::template result >;
 
 namespace detail {
-  template <typename T, typename Fn>
-  auto for_each_impl(T&& agg, Fn&& fn, std::integral_constant<std::size_t,0>) -> void
+  template <typename T>
+  auto tie_impl(T& agg, std::integral_constant<std::size_t, 0>)
   {
-    // do nothing (0 members)
+    // 0 members
+    return std::tie();
   }
 
-  template <typename T, typename Fn>
-  auto for_each_impl(T& agg, Fn&& fn, std::integral_constant<std::size_t, 1>) -> void
+  template <typename T>
+  auto tie_impl(T& agg, std::integral_constant<std::size_t, 1>)
   {
     auto& [m0] = agg;
 
-    fn(m0);
+    return std::tie(m0);
   }
 
-  template <typename T, typename Fn>
-  auto for_each_impl(T& agg, Fn&& fn, std::integral_constant<std::size_t, 2>) -> void
+  template <typename T>
+  auto tie_impl(T& agg, std::integral_constant<std::size_t, 2>)
   {
     auto& [m0, m1] = agg;
 
-    fn(m0); fn(m1);
+    return std::tie(m0, m1);
   }
 
-  template <typename T, typename Fn>
-  auto for_each_impl(T& agg, Fn&& fn, std::integral_constant<std::size_t, 3>) -> void
+  template <typename T>
+  auto tie_impl(T& agg, std::integral_constant<std::size_t, 3>)
   {
     auto& [m0, m1, m2] = agg;
 
-    fn(m0); fn(m1); fn(m2);
+    return std::tie(m0, m1, m2);
   }
-  template <typename T, typename Fn>
-  auto for_each_impl(T& agg, Fn&& fn, std::integral_constant<std::size_t, 4>) -> void
+
+  template <typename T>
+  auto tie_impl(T& agg, std::integral_constant<std::size_t, 4>)
   {
     auto& [m0, m1, m2, m3] = agg;
 
-    fn(m0); fn(m1); fn(m2); fn(m3);
+    return std::tie(m0, m1, m2, m3);
   }
 
-  template <typename T, typename Fn>
-  auto for_each_impl(T& agg, Fn&& fn, std::integral_constant<std::size_t, 5>) -> void
+  template <typename T>
+  auto tie_impl(T& agg, std::integral_constant<std::size_t, 5>)
   {
     auto& [m0, m1, m2, m3, m4] = agg;
 
-    fn(m0); fn(m1); fn(m2); fn(m3); fn(m4);
+    return std::tie(m0, m1, m2, m3, m4);
   }
 
-  template <typename T, typename Fn>
-  auto for_each_impl(T& agg, Fn&& fn, std::integral_constant<std::size_t, 6>) -> void
+  template <typename T>
+  auto tie_impl(T& agg, std::integral_constant<std::size_t, 6>)
   {
     auto& [m0, m1, m2, m3, m4, m5] = agg;
 
-    fn(m0); fn(m1); fn(m2); fn(m3); fn(m4); fn(m5);
+    return std::tie(m0, m1, m2, m3, m4, m5);
   }
 
 } // namespace detail
 
+// Tuple of references to the members of an aggregate
+template <typename T>
+auto tie_members(T& agg)
+{
+  return detail::tie_impl(agg, constructor_arity<std::remove_cv_t<T>>{});
+}
+
 template <typename T, typename Fn>
 void for_each_member(T& agg, Fn&& fn)
 {
-  detail::for_each_impl(agg, std::forward<Fn>(fn), constructor_arity<T>{});
+  std::apply([&](auto&... members) { (fn(members), ...); }, tie_members(agg));
+}
+
+
+namespace detail {
+  // Whether type is or holds (through ranges and aggregates up to 6 members) a view
+  // such as std::string_view or std::span, raw pointers are counted if requested
+  template <typename T, bool Pointers>
+  consteval auto contains_non_owning() -> bool
+  {
+    using U = std::remove_cv_t<T>;
+    if constexpr (std::ranges::view<U>) {
+      return true;
+    }
+    else if constexpr (std::is_pointer_v<U> or std::is_member_pointer_v<U>) {
+      return Pointers;
+    }
+    else if constexpr (std::is_array_v<U>) {
+      return contains_non_owning<std::remove_extent_t<U>, Pointers>();
+    }
+    else if constexpr (std::ranges::range<U>) {
+      // Some ranges like std::filesystem::path have themselves as elements
+      if constexpr (std::same_as<std::ranges::range_value_t<U>, U>) return false;
+      else return contains_non_owning<std::ranges::range_value_t<U>, Pointers>();
+    }
+    else if constexpr (std::is_aggregate_v<U>) {
+      if constexpr (constructor_arity<U>::value <= 6) {
+        return []<typename... Ms>(std::type_identity<std::tuple<Ms&...>>) {
+          return (contains_non_owning<Ms, Pointers>() or ...);
+        }(std::type_identity<decltype(tie_members(std::declval<U&>()))>{});
+      }
+      else return false;
+    }
+    else {
+      return false;
+    }
+  }
+
+  // Whether comparing bytes gives the same answer as ==, so class types and their nested
+  // aggregates (up to 6 members) should not declare operator== of their own
+  template <typename T>
+  consteval auto bitwise_comparable() -> bool
+  {
+    using U = std::remove_cv_t<T>;
+    if constexpr (std::is_scalar_v<U>) {
+      return true;
+    }
+    else if constexpr (std::is_array_v<U>) {
+      return bitwise_comparable<std::remove_extent_t<U>>();
+    }
+    else if constexpr (std::equality_comparable<U>) {
+      return false;
+    }
+    else if constexpr (std::is_aggregate_v<U>) {
+      if constexpr (constructor_arity<U>::value <= 6) {
+        return []<typename... Ms>(std::type_identity<std::tuple<Ms&...>>) {
+          return (bitwise_comparable<Ms>() and ...);
+        }(std::type_identity<decltype(tie_members(std::declval<U&>()))>{});
+      }
+      else return true;
+    }
+    else {
+      return true;
+    }
+  }
+} // namespace detail
+
+/**
+ * Generic hashing, equality and binary serialization for aggregates
+ *
+ * Tightly packed trivially copyable aggregates (no padding, no floating point members)
+ * without operator== anywhere inside are handled as a single block of bytes,
+ * everything else goes member by member. Members may be trivially copyable types,
+ * ranges (std::string, std::vector, ...) and nested aggregates. Aggregates holding
+ * views or pointers can not be serialized, it is checked only for aggregates of up to 6 members.
+ *
+ * Types with operator== are compared with it. Members of such types are hashed with std::hash
+ * if it is specialized and member by member otherwise, then their operator== should agree
+ * with comparing members.
+ */
+template <typename T>
+concept BitwiseAggregate = std::is_trivially_copyable_v<T> and std::has_unique_object_representations_v<T>
+  and not detail::contains_non_owning<T, false>() and detail::bitwise_comparable<T>();
+
+namespace detail {
+  // Whether == of the type compares elements without relying on operator== of aggregates lacking it,
+  // standard containers declare unconstrained operator== so element type is checked instead
+  template <typename T>
+  consteval auto deep_equality_comparable() -> bool
+  {
+    if constexpr (std::ranges::range<T>) {
+      if constexpr (not std::same_as<std::ranges::range_value_t<T>, T>) {
+        return std::equality_comparable<T> and deep_equality_comparable<std::ranges::range_value_t<T>>();
+      }
+      else return std::equality_comparable<T>;
+    }
+    else {
+      return std::equality_comparable<T>;
+    }
+  }
+
+  template <typename T>
+  concept HashableMember = requires(const T& val) {
+    { std::hash<T>{}(val) } -> std::convertible_to<std::size_t>;
+  };
+
+  template <typename T>
+  concept RangeMember = std::ranges::sized_range<T> and not std::is_aggregate_v<T> and requires(T& rng) {
+    rng.push_back(std::declval<std::ranges::range_value_t<T>>());
+    rng.reserve(std::size_t{});
+  };
+
+  template <typename T>
+  concept AggregateMember = std::is_aggregate_v<T> and not std::is_array_v<T>;
+
+  constexpr auto hash_combine(std::size_t seed, std::size_t h) noexcept -> std::size_t
+  {
+    return seed ^ (h + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+  }
+
+  inline auto hash_bytes(const void* data, std::size_t size) noexcept -> std::size_t
+  {
+    return std::hash<std::string_view>{}(std::string_view{static_cast<const char*>(data), size});
+  }
+
+  template <typename T>
+  auto hash_member(const T& val) -> std::size_t;
+
+  template <typename T>
+  auto equal_member(const T& lhs, const T& rhs) -> bool;
+
+  template <typename T>
+  void serialize_member(const T& val, std::vector<std::byte>& out);
+
+  template <typename T>
+  auto deserialize_member(T& val, std::span<const std::byte> buf) -> std::size_t;
+} // namespace detail
+
+template <typename T>
+auto aggregate_hash(const T& agg) -> std::size_t
+{
+  if constexpr (BitwiseAggregate<T>) {
+    return detail::hash_bytes(&agg, sizeof(T));
+  }
+  else {
+    std::size_t seed = 0;
+    for_each_member(agg, [&](const auto& member) {
+      seed = detail::hash_combine(seed, detail::hash_member(member));
+    });
+    return seed;
+  }
+}
+
+// Uses operator== of the aggregate if there is one, so it should not be implemented with this function
+template <typename T>
+auto aggregate_equal(const T& lhs, const T& rhs) -> bool
+{
+  if constexpr (std::equality_comparable<T>) {
+    return lhs == rhs;
+  }
+  else if constexpr (BitwiseAggregate<T>) {
+    return std::memcmp(&lhs, &rhs, sizeof(T)) == 0;
+  }
+  else {
+    return std::apply([&](const auto&... l) {
+      return std::apply([&](const auto&... r) {
+        return (detail::equal_member(l, r) and ...);
+      }, tie_members(rhs));
+    }, tie_members(lhs));
+  }
+}
+
+// Appends binary representation of aggregate to the buffer
+template <typename T>
+void aggregate_serialize(const T& agg, std::vector<std::byte>& out)
+{
+  static_assert(not detail::contains_non_owning<T, true>(), "Aggregates holding views or pointers can not be serialized");
+  if constexpr (BitwiseAggregate<T>) {
+    const auto* bytes = reinterpret_cast<const std::byte*>(&agg);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+  }
+  else {
+    for_each_member(agg, [&](const auto& member) {
+      detail::serialize_member(member, out);
+    });
+  }
+}
+
+template <typename T>
+auto aggregate_serialize(const T& agg) -> std::vector<std::byte>
+{
+  std::vector<std::byte> out;
+  aggregate_serialize(agg, out);
+  return out;
 }
+
+// Returns restored aggregate and count of bytes read
+template <typename T>
+auto aggregate_deserialize(std::span<const std::byte> buf) -> std::pair<T, std::size_t>
+{
+  static_assert(not detail::contains_non_owning<T, true>(), "Aggregates holding views or pointers can not be deserialized");
+  T agg{};
+  if constexpr (BitwiseAggregate<T>) {
+    if (buf.size() < sizeof(T)) throw std::out_of_range{"Buffer is too small for aggregate"};
+    std::memcpy(&agg, buf.data(), sizeof(T));
+    return {agg, sizeof(T)};
+  }
+  else {
+    std::size_t read = 0;
+    for_each_member(agg, [&](auto& member) {
+      read += detail::deserialize_member(member, buf.subspan(read));
+    });
+    return {std::move(agg), read};
+  }
+}
+
+// Function objects for use with unordered containers
+struct aggregate_hasher {
+  template <typename T>
+  auto operator()(const T& agg) const -> std::size_t { return aggregate_hash(agg); }
+};
+
+struct aggregate_equal_to {
+  template <typename T>
+  auto operator()(const T& lhs, const T& rhs) const -> bool { return aggregate_equal(lhs, rhs); }
+};
+
+namespace detail {
+  template <typename T>
+  auto hash_member(const T& val) -> std::size_t
+  {
+    if constexpr (HashableMember<T>) {
+      return std::hash<T>{}(val);
+    }
+    else if constexpr (std::ranges::range<T>) {
+      using Elem = std::ranges::range_value_t<T>;
+      if constexpr (std::ranges::contiguous_range<T> and BitwiseAggregate<Elem>) {
+        return hash_bytes(std::ranges::data(val), std::ranges::size(val) * sizeof(Elem));
+      }
+      else {
+        std::size_t seed = std::ranges::size(val);
+        for (const auto& el : val) {
+          seed = hash_combine(seed, hash_member(el));
+        }
+        return seed;
+      }
+    }
+    else {
+      static_assert(AggregateMember<T>, "Member type is not hashable");
+      return aggregate_hash(val);
+    }
+  }
+
+  template <typename T>
+  auto equal_member(const T& lhs, const T& rhs) -> bool
+  {
+    if constexpr (deep_equality_comparable<T>()) {
+      return lhs == rhs;
+    }
+    else if constexpr (std::ranges::range<T>) {
+      return std::ranges::equal(lhs, rhs, [](const auto& l, const auto& r) { return equal_member(l, r); });
+    }
+    else {
+      static_assert(AggregateMember<T>, "Member type is not comparable");
+      return aggregate_equal(lhs, rhs);
+    }
+  }
+
+  template <typename T>
+  void serialize_member(const T& val, std::vector<std::byte>& out)
+  {
+    static_assert(not contains_non_owning<T, true>(), "Views and pointers can not be serialized");
+    if constexpr (std::is_trivially_copyable_v<T> and not AggregateMember<T>) {
+      const auto* bytes = reinterpret_cast<const std::byte*>(&val);
+      out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+    else if constexpr (RangeMember<T>) {
+      using Elem = std::ranges::range_value_t<T>;
+      const std::size_t size = std::ranges::size(val);
+      serialize_member(size, out);
+      if constexpr (std::ranges::contiguous_range<T> and std::is_trivially_copyable_v<Elem>) {
+        const auto* bytes = reinterpret_cast<const std::byte*>(std::ranges::data(val));
+        out.insert(out.end(), bytes, bytes + size * sizeof(Elem));
+      }
+      else {
+        for (const auto& el : val) {
+          serialize_member(el, out);
+        }
+      }
+    }
+    else {
+      static_assert(AggregateMember<T>, "Member type is not serializable");
+      aggregate_serialize(val, out);
+    }
+  }
+
+  template <typename T>
+  auto deserialize_member(T& val, std::span<const std::byte> buf) -> std::size_t
+  {
+    static_assert(not contains_non_owning<T, true>(), "Views and pointers can not be deserialized");
+    if constexpr (std::is_trivially_copyable_v<T> and not AggregateMember<T>) {
+      if (buf.size() < sizeof(T)) throw std::out_of_range{"Buffer is too small for member"};
+      std::memcpy(&val, buf.data(), sizeof(T));
+      return sizeof(T);
+    }
+    else if constexpr (RangeMember<T>) {
+      using Elem = std::ranges::range_value_t<T>;
+      std::size_t size = 0;
+      std::size_t read = deserialize_member(size, buf);
+      val.clear();
+      if constexpr (std::ranges::contiguous_range<T> and std::is_trivially_copyable_v<Elem>) {
+        // Checked before multiplying, so that corrupted size can not overflow
+        if (size > (buf.size() - read) / sizeof(Elem)) throw std::out_of_range{"Buffer is too small for member"};
+        const std::size_t bytes = size * sizeof(Elem);
+        val.resize(size);
+        if (size != 0) std::memcpy(std::ranges::data(val), buf.data() + read, bytes);
+        read += bytes;
+      }
+      else {
+        // Size is not trusted, every element takes at least a byte unless it is empty
+        val.reserve(std::min(size, buf.size() - read));
+        for (std::size_t i = 0; i < size; i++) {
+          Elem el{};
+          read += deserialize_member(el, buf.subspan(read));
+          val.push_back(std::move(el));
+        }
+      }
+      return read;
+    }
+    else {
+      static_assert(AggregateMember<T>, "Member type is not deserializable");
+      auto [agg, read] = aggregate_deserialize<T>(buf);
+      val = std::move(agg);
+      return read;
+    }
+  }
+} // namespace detail
+
+#if defined(RUN_TESTS) || defined(RUN_BENCH)
+#include <string>
+#include <unordered_set>
+
+#include "test_lib.hpp"
+
+namespace aggregate_helper_test {
+  struct Point { int x, y; };
+  struct Path { std::vector<Point> points; std::vector<std::vector<Point>> segments; };
+  struct Order { long id; double price; std::string symbol; std::vector<int> fills; Point where; };
+
+  // Equality that is not bitwise, values of the same ten are equal
+  struct Decade {
+    int year;
+    auto operator==(const Decade& other) const -> bool { return year / 10 == other.year / 10; }
+  };
+  struct Event { Decade when; int id; };
+
+  inline auto make_order() -> Order
+  {
+    return {42, 101.5, "AAPL", {1, 2, 3, 5, 8}, {3, 4}};
+  }
+
+  // Hand written counterparts to compare generated code against
+  inline auto hand_hash(const Order& order) -> std::size_t
+  {
+    std::size_t seed = 0;
+    seed = detail::hash_combine(seed, std::hash<long>{}(order.id));
+    seed = detail::hash_combine(seed, std::hash<double>{}(order.price));
+    seed = detail::hash_combine(seed, std::hash<std::string>{}(order.symbol));
+    seed = detail::hash_combine(seed, detail::hash_bytes(order.fills.data(), order.fills.size() * sizeof(int)));
+    seed = detail::hash_combine(seed, detail::hash_bytes(&order.where, sizeof(Point)));
+    return seed;
+  }
+
+  inline auto hand_equal(const Order& lhs, const Order& rhs) -> bool
+  {
+    return lhs.id == rhs.id and lhs.price == rhs.price and lhs.symbol == rhs.symbol
+      and lhs.fills == rhs.fills and lhs.where.x == rhs.where.x and lhs.where.y == rhs.where.y;
+  }
+
+  inline void hand_serialize(const Order& order, std::vector<std::byte>& out)
+  {
+    const auto append = [&](const void* data, std::size_t size) {
+      const auto* bytes = static_cast<const std::byte*>(data);
+      out.insert(out.end(), bytes, bytes + size);
+    };
+    const std::size_t symbol_size = order.symbol.size();
+    const std::size_t fills_size = order.fills.size();
+    append(&order.id, sizeof(order.id));
+    append(&order.price, sizeof(order.price));
+    append(&symbol_size, sizeof(symbol_size));
+    append(order.symbol.data(), symbol_size);
+    append(&fills_size, sizeof(fills_size));
+    append(order.fills.data(), fills_size * sizeof(int));
+    append(&order.where, sizeof(Point));
+  }
+} // namespace aggregate_helper_test
+
+template <>
+struct std::hash<aggregate_helper_test::Decade> {
+  auto operator()(const aggregate_helper_test::Decade& decade) const noexcept -> std::size_t
+  {
+    return std::hash<int>{}(decade.year / 10);
+  }
+};
+
+TESTS_BEGIN
+{"aggregate_helper", {
+  {
+    "Equality of nested aggregates and ranges of aggregates without operator==",
+    []{
+      using namespace aggregate_helper_test;
+      Path lhs{{{1, 2}, {3, 4}}, {{{5, 6}}, {}}};
+      Path rhs = lhs;
+      if (not aggregate_equal(lhs, rhs)) return false;
+      rhs.segments[0][0].y = 7;
+      if (aggregate_equal(lhs, rhs)) return false;
+      rhs = lhs;
+      rhs.points.pop_back();
+      return not aggregate_equal(lhs, rhs);
+    }
+  },
+  {
+    "Equal aggregates have equal hashes",
+    []{
+      using namespace aggregate_helper_test;
+      const Order order = make_order();
+      Order copy = order;
+      if (aggregate_hash(order) != aggregate_hash(copy)) return false;
+      copy.symbol = "MSFT";
+      std::unordered_set<Order, aggregate_hasher, aggregate_equal_to> set{order, copy, make_order()};
+      return set.size() == 2;
+    }
+  },
+  {
+    "Hash and equality agree for members with own operator==",
+    []{
+      using namespace aggregate_helper_test;
+      static_assert(not BitwiseAggregate<Decade> and not BitwiseAggregate<Event> and BitwiseAggregate<Point>);
+      const Event lhs{{1991}, 1};
+      const Event rhs{{1995}, 1};
+      return aggregate_equal(lhs, rhs) and aggregate_hash(lhs) == aggregate_hash(rhs)
+        and aggregate_equal(lhs.when, rhs.when) and not aggregate_equal(lhs, Event{{2001}, 1});
+    }
+  },
+  {
+    "Serialization roundtrip",
+    []{
+      using namespace aggregate_helper_test;
+      const Order order = make_order();
+      const Path path{{{1, 2}}, {{{3, 4}, {5, 6}}, {}}};
+      auto buf = aggregate_serialize(order);
+      aggregate_serialize(path, buf);
+
+      const auto [restored_order, order_size] = aggregate_deserialize<Order>(buf);
+      const auto [restored_path, path_size] = aggregate_deserialize<Path>(std::span{buf}.subspan(order_size));
+      return aggregate_equal(order, restored_order) and aggregate_equal(path, restored_path)
+        and order_size + path_size == buf.size();
+    }
+  },
+  {
+    "Deserialization of truncated buffer throws",
+    []{
+      using namespace aggregate_helper_test;
+      auto buf = aggregate_serialize(make_order());
+      buf.resize(buf.size() - 1);
+      try {
+        (void)aggregate_deserialize<Order>(buf);
+      }
+      catch (const std::out_of_range&) {
+        return true;
+      }
+      return false;
+    }
+  },
+  {
+    "Deserialization of corrupted size throws",
+    []{
+      using namespace aggregate_helper_test;
+      // Size of points, wrapping to 0 bytes when multiplied by sizeof(Point), then plain too big sizes
+      // of points and of segments which are deserialized element by element
+      const std::pair<std::size_t, std::size_t> corruptions[] = {
+        {0, std::size_t{1} << 61}, {0, 1000}, {sizeof(std::size_t), std::size_t{1} << 61}
+      };
+      for (const auto& [offset, size] : corruptions) {
+        std::vector<std::byte> buf;
+        aggregate_serialize(Path{}, buf);
+        std::memcpy(buf.data() + offset, &size, sizeof(size));
+        try {
+          (void)aggregate_deserialize<Path>(buf);
+          return false;
+        }
+        catch (const std::out_of_range&) {}
+      }
+      return true;
+    }
+  },
+  {
+    "Views and pointers are not serialized as raw bytes",
+    []{
+      struct View { std::string_view text; };
+      struct Pointer { const int* ptr; long size; };
+      struct Nested { int id; std::vector<View> views; };
+      return not BitwiseAggregate<View> and BitwiseAggregate<Pointer>
+        and detail::contains_non_owning<Nested, false>() and detail::contains_non_owning<Pointer, true>()
+        and not detail::contains_non_owning<aggregate_helper_test::Order, true>();
+    }
+  }
+}}
+TESTS_END
+
+BENCH_BEGIN
+{"aggregate_helper", {
+  {
+    "aggregate_hash",
+    [order = aggregate_helper_test::make_order()]{
+      TESTING::do_not_optimize(order);
+      auto hash = aggregate_hash(order);
+      TESTING::do_not_optimize(hash);
+    }
+  },
+  {
+    "hand written hash",
+    [order = aggregate_helper_test::make_order()]{
+      TESTING::do_not_optimize(order);
+      auto hash = aggregate_helper_test::hand_hash(order);
+      TESTING::do_not_optimize(hash);
+    }
+  },
+  {
+    "aggregate_equal",
+    [lhs = aggregate_helper_test::make_order(), rhs = aggregate_helper_test::make_order()]{
+      TESTING::do_not_optimize(lhs);
+      TESTING::do_not_optimize(rhs);
+      auto equal = aggregate_equal(lhs, rhs);
+      TESTING::do_not_optimize(equal);
+    }
+  },
+  {
+    "hand written equality",
+    [lhs = aggregate_helper_test::make_order(), rhs = aggregate_helper_test::make_order()]{
+      TESTING::do_not_optimize(lhs);
+      TESTING::do_not_optimize(rhs);
+      auto equal = aggregate_helper_test::hand_equal(lhs, rhs);
+      TESTING::do_not_optimize(equal);
+    }
+  },
+  {
+    "aggregate_serialize",
+    [order = aggregate_helper_test::make_order(), buf = std::vector<std::byte>{}]() mutable {
+      buf.clear();
+      aggregate_serialize(order, buf);
+      TESTING::do_not_optimize(buf);
+    }
+  },
+  {
+    "hand written serialization",
+    [order = aggregate_helper_test::make_order(), buf = std::vector<std::byte>{}]() mutable {
+      buf.clear();
+      aggregate_helper_test::hand_serialize(order, buf);
+      TESTING::do_not_optimize(buf);
+    }
+  },
+  {
+    "aggregate_deserialize",
+    [buf = aggregate_serialize(aggregate_helper_test::make_order())]{
+      auto order = aggregate_deserialize<aggregate_helper_test::Order>(buf);
+      TESTING::do_not_optimize(order);
+    }
+  }
+}}
+BENCH_END
+#endif // RUN_TESTS || RUN_BENCH
@@ -0,0 +1,438 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <utility>
+
+/* Usage:
+MonotonicArena arena;
+std::pmr::vector<std::pmr::string> strings{&arena};  // freed all at once with arena
+
+SlabPool<> pool;  // thread safe, so producers and consumers on different threads may share it
+PmrConcurrentQueue<Message> queue{&pool};
+*/
+
+namespace detail
+{
+    constexpr std::size_t align_up(std::size_t size, std::size_t alignment) noexcept
+    {
+        return (size + alignment - 1) & ~(alignment - 1);
+    }
+
+    // Intrusive singly linked list of free blocks
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+}  // namespace detail
+
+/**
+ * Bump pointer arena, deallocation is no-op and memory is returned on release or destruction
+ *
+ * Chunks are requested from upstream growing geometrically, optional initial buffer
+ * is used first so short lived arenas on stack do not touch heap at all.
+ */
+class MonotonicArena : public std::pmr::memory_resource
+{
+public:
+    explicit MonotonicArena(std::size_t chunk_size = 4096,
+                            std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept
+        : m_upstream{upstream}, m_next_chunk_size{std::max(chunk_size, sizeof(Chunk) * 2)} {}
+
+    MonotonicArena(void* buffer, std::size_t size,
+                   std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept
+        : m_upstream{upstream}, m_next_chunk_size{std::max(size * 2, sizeof(Chunk) * 2)},
+          m_initial{static_cast<std::byte*>(buffer)}, m_initial_size{size},
+          m_current{m_initial}, m_end{m_initial + size} {}
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    ~MonotonicArena() override { release(); }
+
+    // Returns all chunks to upstream, initial buffer is reused
+    void release() noexcept
+    {
+        while (m_chunks != nullptr)
+        {
+            Chunk* next = m_chunks->next;
+            m_upstream->deallocate(m_chunks, m_chunks->size, alignof(Chunk));
+            m_chunks = next;
+        }
+        m_current = m_initial;
+        m_end = m_initial == nullptr ? nullptr : m_initial + m_initial_size;
+    }
+
+    std::pmr::memory_resource* upstream_resource() const noexcept { return m_upstream; }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        if (void* ptr = bump(bytes, alignment)) return ptr;
+
+        const std::size_t needed = detail::align_up(sizeof(Chunk), alignment) + bytes;
+        const std::size_t size = std::max(m_next_chunk_size, needed);
+        auto* chunk = static_cast<Chunk*>(m_upstream->allocate(size, alignof(Chunk)));
+        chunk->next = m_chunks;
+        chunk->size = size;
+        m_chunks = chunk;
+        m_current = reinterpret_cast<std::byte*>(chunk) + sizeof(Chunk);
+        m_end = reinterpret_cast<std::byte*>(chunk) + size;
+        m_next_chunk_size = size * 2;
+
+        return bump(bytes, alignment);
+    }
+
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+private:
+    struct alignas(std::max_align_t) Chunk
+    {
+        Chunk* next;
+        std::size_t size;
+    };
+
+    void* bump(std::size_t bytes, std::size_t alignment) noexcept
+    {
+        void* ptr = m_current;
+        std::size_t space = static_cast<std::size_t>(m_end - m_current);
+        if (m_current == nullptr or std::align(alignment, bytes, ptr, space) == nullptr) return nullptr;
+        m_current = static_cast<std::byte*>(ptr) + bytes;
+        return ptr;
+    }
+
+    std::pmr::memory_resource* m_upstream;
+    std::size_t m_next_chunk_size;
+    std::byte* m_initial = nullptr;
+    std::size_t m_initial_size = 0;
+    std::byte* m_current = nullptr;
+    std::byte* m_end = nullptr;
+    Chunk* m_chunks = nullptr;
+};
+
+/**
+ * Pool of fixed size blocks, not synchronized
+ *
+ * Requests up to BlockSize bytes are served from free list, bigger or over aligned
+ * requests go to upstream. Memory is returned to upstream only on destruction.
+ * Meant for many objects of one small type. Containers allocating blocks of other sizes,
+ * like std::deque with its 512 byte blocks and growing map behind ConcurrentQueue,
+ * bypass the pool on every allocation, use SlabPool for them.
+ */
+template<std::size_t BlockSize, std::size_t BlocksPerChunk = 256>
+class ObjectPool : public std::pmr::memory_resource
+{
+    static constexpr std::size_t Block = detail::align_up(
+        std::max(BlockSize, sizeof(detail::FreeBlock)), alignof(std::max_align_t));
+
+public:
+    explicit ObjectPool(std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept
+        : m_arena{Block * BlocksPerChunk, upstream} {}
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        if (bytes > BlockSize or alignment > alignof(std::max_align_t))
+        {
+            return m_arena.upstream_resource()->allocate(bytes, alignment);
+        }
+        if (m_free != nullptr)
+        {
+            return std::exchange(m_free, m_free->next);
+        }
+        return m_arena.allocate(Block, alignof(std::max_align_t));
+    }
+
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override
+    {
+        if (bytes > BlockSize or alignment > alignof(std::max_align_t))
+        {
+            m_arena.upstream_resource()->deallocate(ptr, bytes, alignment);
+            return;
+        }
+        m_free = ::new (ptr) detail::FreeBlock{m_free};
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+private:
+    MonotonicArena m_arena;
+    detail::FreeBlock* m_free = nullptr;
+};
+
+// Pool owned by calling thread, memory from it should be released on the same thread
+template<std::size_t BlockSize>
+ObjectPool<BlockSize>& thread_local_pool()
+{
+    thread_local ObjectPool<BlockSize> pool;
+    return pool;
+}
+
+/**
+ * Thread safe slab pool with power of two size classes from 16 bytes to MaxBlockSize
+ *
+ * Every size class has its own lock, so threads allocating different sizes do not contend.
+ * Bigger or over aligned requests go to upstream.
+ */
+template<std::size_t MaxBlockSize = 1024, std::size_t SlabSize = 64 * 1024>
+class SlabPool : public std::pmr::memory_resource
+{
+    static constexpr std::size_t MinBlockSize = 16;
+    static constexpr std::size_t ClassCount = std::bit_width(MaxBlockSize / MinBlockSize);
+
+    static_assert(std::has_single_bit(MaxBlockSize) and MaxBlockSize >= MinBlockSize,
+        "MaxBlockSize should be power of two not less than 16");
+
+public:
+    explicit SlabPool(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : m_upstream{upstream}
+    {
+        for (auto& size_class : m_classes)
+        {
+            size_class.arena = std::make_unique<MonotonicArena>(SlabSize, upstream);
+        }
+    }
+
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        if (bytes > MaxBlockSize or alignment > alignof(std::max_align_t))
+        {
+            return m_upstream->allocate(bytes, alignment);
+        }
+        const std::size_t index = class_index(bytes);
+        auto& size_class = m_classes[index];
+        std::lock_guard lk{size_class.mtx};
+        if (size_class.free != nullptr)
+        {
+            return std::exchange(size_class.free, size_class.free->next);
+        }
+        return size_class.arena->allocate(MinBlockSize << index, alignof(std::max_align_t));
+    }
+
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override
+    {
+        if (bytes > MaxBlockSize or alignment > alignof(std::max_align_t))
+        {
+            m_upstream->deallocate(ptr, bytes, alignment);
+            return;
+        }
+        auto& size_class = m_classes[class_index(bytes)];
+        std::lock_guard lk{size_class.mtx};
+        size_class.free = ::new (ptr) detail::FreeBlock{size_class.free};
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+private:
+    static constexpr std::size_t class_index(std::size_t bytes) noexcept
+    {
+        return bytes <= MinBlockSize ? 0 : std::bit_width((bytes - 1) / MinBlockSize);
+    }
+
+    struct alignas(64) SizeClass
+    {
+        std::mutex mtx;
+        detail::FreeBlock* free = nullptr;
+        std::unique_ptr<MonotonicArena> arena;
+    };
+
+    std::pmr::memory_resource* m_upstream;
+    std::array<SizeClass, ClassCount> m_classes;
+};
+
+#if defined(RUN_TESTS) || defined(RUN_BENCH)
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "concurent_queue.hpp"
+#include "test_lib.hpp"
+
+namespace allocators_test
+{
+    // Counts requests passed to upstream
+    class CountingResource : public std::pmr::memory_resource
+    {
+    public:
+        std::size_t allocations = 0;
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            allocations++;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override
+        {
+            std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+
+    // Queue growing to Backlog elements and drained, Rounds times
+    inline void queue_workload(std::pmr::memory_resource* resource, std::size_t rounds = 10, std::size_t backlog = 1000)
+    {
+        PmrConcurrentQueue<std::uint64_t> queue{resource};
+        for (std::size_t round = 0; round < rounds; round++)
+        {
+            for (std::size_t i = 0; i < backlog; i++) queue.push(i);
+            while (auto val = queue.pop()) TESTING::do_not_optimize(*val);
+        }
+    }
+
+    // Threads allocate and free blocks of random sizes up to 1 KiB, keeping up to 64 alive each
+    inline void churn(std::pmr::memory_resource* resource, std::size_t thread_count, std::size_t operations = 10000)
+    {
+        std::vector<std::jthread> threads;
+        for (std::size_t t = 0; t < thread_count; t++)
+        {
+            threads.emplace_back([resource, operations, t] {
+                std::minstd_rand rng{static_cast<std::uint32_t>(t + 1)};
+                std::array<std::pair<void*, std::size_t>, 64> live{};
+                for (std::size_t i = 0; i < operations; i++)
+                {
+                    auto& [ptr, size] = live[rng() % live.size()];
+                    if (ptr != nullptr) resource->deallocate(ptr, size);
+                    size = 16 + rng() % 1009;
+                    ptr = resource->allocate(size);
+                }
+                for (auto& [ptr, size] : live)
+                {
+                    if (ptr != nullptr) resource->deallocate(ptr, size);
+                }
+            });
+        }
+    }
+}  // namespace allocators_test
+
+TESTS_BEGIN
+{"allocators", {
+    {
+        "Queue on SlabPool allocates from upstream only per slab",
+        []{
+            allocators_test::CountingResource upstream;
+            {
+                SlabPool<> pool{&upstream};
+                allocators_test::queue_workload(&pool);
+            }
+            return upstream.allocations < 10;
+        }
+    },
+    {
+        "ObjectPool reuses freed blocks",
+        []{
+            allocators_test::CountingResource upstream;
+            ObjectPool<64> pool{&upstream};
+            void* first = pool.allocate(64);
+            pool.deallocate(first, 64);
+            void* second = pool.allocate(48);
+            pool.deallocate(second, 48);
+            return first == second and upstream.allocations == 1;
+        }
+    },
+    {
+        "thread_local_pool reuses freed blocks",
+        []{
+            // Fresh thread, so the pool is not shared with other tests
+            bool reused = false;
+            std::jthread{[&] {
+                auto& pool = thread_local_pool<32>();
+                void* first = pool.allocate(32);
+                pool.deallocate(first, 32);
+                void* second = pool.allocate(32);
+                pool.deallocate(second, 32);
+                reused = first == second and &pool == &thread_local_pool<32>();
+            }}.join();
+            return reused;
+        }
+    },
+    {
+        "Arena reuses initial buffer after release",
+        []{
+            allocators_test::CountingResource upstream;
+            alignas(std::max_align_t) std::byte buffer[256];
+            MonotonicArena arena{buffer, sizeof(buffer), &upstream};
+            void* first = arena.allocate(100);
+            (void)arena.allocate(1000);
+            arena.release();
+            return first == buffer and arena.allocate(100) == first and upstream.allocations == 1;
+        }
+    }
+}}
+TESTS_END
+
+BENCH_BEGIN
+{"allocators, queue of 1000 elements filled and drained 10 times on fresh resource", {
+    {
+        "new_delete_resource",
+        []{
+            allocators_test::CountingResource upstream;
+            allocators_test::queue_workload(&upstream);
+            TESTING::bench_counter("upstream_allocations", static_cast<double>(upstream.allocations));
+        }
+    },
+    {
+        "ObjectPool<64>",
+        []{
+            allocators_test::CountingResource upstream;
+            {
+                ObjectPool<64> pool{&upstream};
+                allocators_test::queue_workload(&pool);
+            }
+            TESTING::bench_counter("upstream_allocations", static_cast<double>(upstream.allocations));
+        }
+    },
+    {
+        "SlabPool",
+        []{
+            allocators_test::CountingResource upstream;
+            {
+                SlabPool<> pool{&upstream};
+                allocators_test::queue_workload(&pool);
+            }
+            TESTING::bench_counter("upstream_allocations", static_cast<double>(upstream.allocations));
+        }
+    }
+}}
+BENCH_END
+
+BENCH_BEGIN
+{"allocators, 4 threads churning 10000 blocks of 16 to 1024 bytes each", {
+    {"new_delete_resource", []{ allocators_test::churn(std::pmr::new_delete_resource(), 4); }},
+    {
+        "std::pmr::synchronized_pool_resource",
+        [pool = std::make_shared<std::pmr::synchronized_pool_resource>()]{ allocators_test::churn(pool.get(), 4); }
+    },
+    {"SlabPool", [pool = std::make_shared<SlabPool<>>()]{ allocators_test::churn(pool.get(), 4); }}
+}}
+BENCH_END
+#endif  // RUN_TESTS || RUN_BENCH
@@ -0,0 +1,389 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include "concurent_queue.hpp"
+
+/* Usage:
+QueueExecutor executor;
+async_channel<Request, QueueExecutor> channel{executor, 128};
+
+Task consumer() {
+    while (auto request = co_await channel.pop()) {
+        handle(*request);
+    }
+}
+
+Task producer() {
+    co_await channel.push(Request{});  // suspends while channel is full
+}
+
+executor.run_pending();  // resumes coroutines woken by channel
+*/
+
+template <typename T>
+concept CoroutineExecutor = requires(T ex, std::coroutine_handle<> handle) {
+    ex.execute(handle);
+};
+
+// Resumes woken coroutine right away on the thread that woke it
+struct InlineExecutor {
+    void execute(std::coroutine_handle<> handle) {
+        handle.resume();
+    }
+};
+
+// Collects woken coroutines, they are resumed by whichever thread calls run_pending
+class QueueExecutor {
+    ConcurrentQueue<std::coroutine_handle<>> m_ready;
+
+public:
+    void execute(std::coroutine_handle<> handle) {
+        m_ready.push(handle);
+    }
+
+    // Returns count of resumed coroutines
+    std::size_t run_pending() {
+        std::size_t count = 0;
+        while (auto handle = m_ready.pop()) {
+            handle->resume();
+            count++;
+        }
+        return count;
+    }
+};
+
+/**
+ * Channel for coroutines, awaiting pop or push on a full channel suspends coroutine
+ * without blocking a thread
+ *
+ * Every push or pop wakes at most one waiter, woken coroutines are resumed through executor.
+ * Capacity 0 makes rendezvous channel where push completes only when a pop takes the value.
+ * After close pending and further pops get std::nullopt once channel is drained
+ * and pushes return false.
+ *
+ * Items live in a plain deque under the channel lock rather than in ConcurrentQueue,
+ * as count of items has to be checked together with waiter lists.
+ */
+template <typename T, CoroutineExecutor Executor = InlineExecutor>
+class async_channel {
+public:
+    using value_type = T;
+
+    class PopAwaiter {
+        friend class async_channel;
+
+        async_channel& m_channel;
+        std::coroutine_handle<> m_handle;
+        std::optional<T> m_result;
+
+    public:
+        explicit PopAwaiter(async_channel& channel) : m_channel{channel} {}
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            m_handle = handle;
+            return m_channel.suspend_pop(*this);
+        }
+
+        std::optional<T> await_resume() {
+            return std::move(m_result);
+        }
+    };
+
+    class PushAwaiter {
+        friend class async_channel;
+
+        async_channel& m_channel;
+        std::coroutine_handle<> m_handle;
+        T m_value;
+        bool m_delivered = false;
+
+    public:
+        PushAwaiter(async_channel& channel, T value) : m_channel{channel}, m_value{std::move(value)} {}
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            m_handle = handle;
+            return m_channel.suspend_push(*this);
+        }
+
+        // false if channel was closed before value was accepted
+        bool await_resume() const noexcept {
+            return m_delivered;
+        }
+    };
+
+    explicit async_channel(Executor& executor, std::size_t capacity = std::numeric_limits<std::size_t>::max())
+        : m_executor{executor}, m_capacity{capacity} {}
+
+    async_channel(const async_channel&) = delete;
+    async_channel& operator=(const async_channel&) = delete;
+
+    [[nodiscard]] PopAwaiter pop() {
+        return PopAwaiter{*this};
+    }
+
+    [[nodiscard]] PushAwaiter push(T value) {
+        return PushAwaiter{*this, std::move(value)};
+    }
+
+    // Push for non coroutine producers, false if channel is full or closed
+    bool try_push(T value) {
+        std::unique_lock lk{m_mtx};
+        if (m_closed) {
+            return false;
+        }
+        if (not m_pop_waiters.empty()) {
+            hand_over(lk, std::move(value));
+            return true;
+        }
+        if (m_items.size() >= m_capacity) {
+            return false;
+        }
+        m_items.push_back(std::move(value));
+        return true;
+    }
+
+    void close() {
+        std::deque<PopAwaiter*> pop_waiters;
+        std::deque<PushAwaiter*> push_waiters;
+        {
+            std::lock_guard lk{m_mtx};
+            m_closed = true;
+            pop_waiters.swap(m_pop_waiters);
+            push_waiters.swap(m_push_waiters);
+        }
+        for (auto* waiter : pop_waiters) {
+            m_executor.execute(waiter->m_handle);
+        }
+        for (auto* waiter : push_waiters) {
+            m_executor.execute(waiter->m_handle);
+        }
+    }
+
+private:
+    // Returns true if coroutine should stay suspended
+    bool suspend_pop(PopAwaiter& awaiter) {
+        std::unique_lock lk{m_mtx};
+        if (not m_items.empty()) {
+            awaiter.m_result = std::move(m_items.front());
+            m_items.pop_front();
+            if (not m_push_waiters.empty()) {
+                auto* pusher = m_push_waiters.front();
+                m_push_waiters.pop_front();
+                m_items.push_back(std::move(pusher->m_value));
+                pusher->m_delivered = true;
+                lk.unlock();
+                m_executor.execute(pusher->m_handle);
+            }
+            return false;
+        }
+        if (not m_push_waiters.empty()) {
+            // Only happens with capacity 0, value is taken from waiting producer directly
+            auto* pusher = m_push_waiters.front();
+            m_push_waiters.pop_front();
+            awaiter.m_result = std::move(pusher->m_value);
+            pusher->m_delivered = true;
+            lk.unlock();
+            m_executor.execute(pusher->m_handle);
+            return false;
+        }
+        if (m_closed) {
+            return false;
+        }
+        m_pop_waiters.push_back(&awaiter);
+        return true;
+    }
+
+    bool suspend_push(PushAwaiter& awaiter) {
+        std::unique_lock lk{m_mtx};
+        if (m_closed) {
+            return false;
+        }
+        if (not m_pop_waiters.empty()) {
+            awaiter.m_delivered = true;
+            hand_over(lk, std::move(awaiter.m_value));
+            return false;
+        }
+        if (m_items.size() < m_capacity) {
+            m_items.push_back(std::move(awaiter.m_value));
+            awaiter.m_delivered = true;
+            return false;
+        }
+        m_push_waiters.push_back(&awaiter);
+        return true;
+    }
+
+    // Gives value directly to first waiting consumer and resumes it, releases lock
+    void hand_over(std::unique_lock<std::mutex>& lk, T&& value) {
+        auto* popper = m_pop_waiters.front();
+        m_pop_waiters.pop_front();
+        popper->m_result = std::move(value);
+        lk.unlock();
+        m_executor.execute(popper->m_handle);
+    }
+
+    Executor& m_executor;
+    const std::size_t m_capacity;
+    std::mutex m_mtx;
+    std::deque<T> m_items;
+    std::deque<PopAwaiter*> m_pop_waiters;
+    std::deque<PushAwaiter*> m_push_waiters;
+    bool m_closed = false;
+};
+
+#if defined(RUN_TESTS) || defined(RUN_BENCH)
+#include <condition_variable>
+#include <exception>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "test_lib.hpp"
+
+namespace async_channel_test {
+    // Coroutine started eagerly and destroyed on completion
+    struct Task {
+        struct promise_type {
+            Task get_return_object() noexcept { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() noexcept { std::terminate(); }
+        };
+    };
+
+    template <typename Channel>
+    Task produce(Channel& channel, int count) {
+        for (int i = 0; i < count; i++) {
+            co_await channel.push(i);
+        }
+        channel.close();
+    }
+
+    template <typename Channel>
+    Task consume(Channel& channel, std::vector<int>& received) {
+        while (auto value = co_await channel.pop()) {
+            received.push_back(*value);
+        }
+    }
+
+    template <typename Channel>
+    Task sum(Channel& channel, long& total) {
+        while (auto value = co_await channel.pop()) {
+            total += *value;
+        }
+    }
+
+    constexpr int BenchValues = 10000;
+
+    // Coroutines handing values through channel on one thread
+    template <typename Executor>
+    void channel_handoff(std::size_t capacity) {
+        Executor executor;
+        async_channel<int, Executor> channel{executor, capacity};
+        long total = 0;
+        sum(channel, total);
+        produce(channel, BenchValues);
+        if constexpr (requires { executor.run_pending(); }) {
+            while (executor.run_pending() > 0) {}
+        }
+        TESTING::do_not_optimize(total);
+    }
+
+    // Same handoff between two threads blocking on condition variables
+    inline void condvar_handoff(std::size_t capacity) {
+        std::mutex mtx;
+        std::condition_variable not_empty;
+        std::condition_variable not_full;
+        std::queue<int> items;
+        bool closed = false;
+        long total = 0;
+
+        std::jthread consumer{[&] {
+            std::unique_lock lk{mtx};
+            while (true) {
+                not_empty.wait(lk, [&] { return not items.empty() or closed; });
+                if (items.empty()) break;
+                total += items.front();
+                items.pop();
+                not_full.notify_one();
+            }
+        }};
+        for (int i = 0; i < BenchValues; i++) {
+            std::unique_lock lk{mtx};
+            not_full.wait(lk, [&] { return items.size() < capacity; });
+            items.push(i);
+            not_empty.notify_one();
+        }
+        {
+            std::lock_guard lk{mtx};
+            closed = true;
+        }
+        not_empty.notify_one();
+        consumer.join();
+        TESTING::do_not_optimize(total);
+    }
+}  // namespace async_channel_test
+
+TESTS_BEGIN
+{"async_channel", {
+    {
+        "Rendezvous channel with consumer waiting first",
+        []{
+            using namespace async_channel_test;
+            InlineExecutor executor;
+            async_channel<int> channel{executor, 0};
+            std::vector<int> received;
+            consume(channel, received);
+            produce(channel, 5);
+            return received == std::vector<int>{0, 1, 2, 3, 4};
+        }
+    },
+    {
+        "Rendezvous channel with producer waiting first",
+        []{
+            using namespace async_channel_test;
+            InlineExecutor executor;
+            async_channel<int> channel{executor, 0};
+            std::vector<int> received;
+            if (channel.try_push(42)) return false;
+            produce(channel, 5);
+            consume(channel, received);
+            return received == std::vector<int>{0, 1, 2, 3, 4};
+        }
+    },
+    {
+        "Bounded channel through queue executor",
+        []{
+            using namespace async_channel_test;
+            QueueExecutor executor;
+            async_channel<int, QueueExecutor> channel{executor, 2};
+            std::vector<int> received;
+            produce(channel, 100);
+            consume(channel, received);
+            while (executor.run_pending() > 0) {}
+            return received.size() == 100 and received.back() == 99;
+        }
+    }
+}}
+TESTS_END
+
+BENCH_BEGIN
+{"async_channel, 10000 values from producer to consumer", {
+    {"condition_variable, 2 threads, capacity 16", []{ async_channel_test::condvar_handoff(16); }},
+    {"async_channel, InlineExecutor, capacity 16", []{ async_channel_test::channel_handoff<InlineExecutor>(16); }},
+    {"async_channel, InlineExecutor, capacity 0", []{ async_channel_test::channel_handoff<InlineExecutor>(0); }},
+    {"async_channel, QueueExecutor, capacity 16", []{ async_channel_test::channel_handoff<QueueExecutor>(16); }}
+}}
+BENCH_END
+#endif  // RUN_TESTS || RUN_BENCH
@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+"""
+Compile time benchmark for metaprogramming headers
+
+Generates synthetic translation units of increasing size for every header,
+compiles them and prints a table with wall time, peak compiler memory and
+time spent in template instantiation and constant evaluation.
+
+GCC reports phase times via -ftime-report. Clang reports them via -ftime-trace,
+where count of constant evaluations is reported too. Neither compiler exposes
+raw constexpr step counts.
+
+Usage:
+    ./compile_bench.py [--cxx g++] [--sizes 1,10,50] [--only ct2rt] [--history bench_history.jsonl]
+"""
+
+import argparse
+import datetime
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+REPO_DIR = os.path.dirname(os.path.abspath(__file__))
+
+
+def gen_ct2rt(size):
+    # `size` types each moved from compile time to runtime with vector of `size` elements
+    lines = [
+        '#include "ct2rt.hpp"',
+        '#include <vector>',
+        '',
+        'struct Vec {',
+        '    std::vector<int> v;',
+        '    constexpr Vec(std::vector<int> x) : v{std::move(x)} {}',
+        '    template<std::size_t N> constexpr Vec(const std::array<int, N>& a) : v(a.begin(), a.end()) {}',
+        '    constexpr std::size_t sizes_count() const { return 1; }',
+        '    template<std::size_t C> constexpr std::array<std::size_t, C> sizes() const { return {v.size()}; }',
+        '    template<std::array<std::size_t, 1> S> constexpr std::array<int, S[0]> serialize() const {',
+        '        std::array<int, S[0]> a{};',
+        '        std::copy(v.begin(), v.end(), a.begin());',
+        '        return a;',
+        '    }',
+        '};',
+        '',
+    ]
+    for i in range(size):
+        lines.append(
+            f'constexpr auto get{i} = [] {{ return [] {{ std::vector<int> v; '
+            f'for (int i = 0; i < {size + i}; i++) v.push_back(i); return Vec{{v}}; }}; }};')
+    lines.append('int main() {')
+    lines.append('    int sum = 0;')
+    for i in range(size):
+        lines.append(f'    sum += Vec{{to_runtime<get{i}>()}}.v.back();')
+    lines.append('    return sum;')
+    lines.append('}')
+    return '\n'.join(lines)
+
+
+def gen_to_runtime(size):
+    # `size` compile time vectors of `size` strings
+    lines = ['#include "to_runtime.hpp"', '']
+    for i in range(size):
+        lines.append(
+            f'constexpr auto make{i} = [] {{ std::vector<std::string> v; '
+            f'for (int i = 0; i < {size}; i++) v.push_back("item" + std::to_string(i + {i})); return v; }};')
+    lines.append('int main() {')
+    lines.append('    std::size_t sum = 0;')
+    for i in range(size):
+        lines.append(
+            f'    sum += static_cast<std::vector<std::string>>(cross_container<make{i}, uint16_t>).size();')
+    lines.append('    return static_cast<int>(sum);')
+    lines.append('}')
+    return '\n'.join(lines)
+
+
+def gen_aggregate_helper(size):
+    # `size` aggregates with 1 to 6 members, arity search and member iteration for each
+    types = ['int', 'double', 'char', 'long', 'float', 'short']
+    lines = ['#include "aggregate_helper.hpp"', '']
+    for i in range(size):
+        count = i % 6 + 1
+        members = ' '.join(f'{types[(i + m) % 6]} m{m};' for m in range(count))
+        lines.append(f'struct S{i} {{ {members} }};')
+        lines.append(f'static_assert(constructor_arity<S{i}>::value == {count});')
+    lines.append('int main() {')
+    lines.append('    int count = 0;')
+    for i in range(size):
+        lines.append(f'    {{ S{i} s{{}}; for_each_member(s, [&](auto&) {{ count++; }}); }}')
+    lines.append('    return count;')
+    lines.append('}')
+    return '\n'.join(lines)
+
+
+def gen_template_strings(size):
+    # `size` distinct String instantiations checked at compile time
+    lines = ['#include "template_strings.hpp"', '']
+    for i in range(size):
+        lines.append(f'using Str{i} = String<"string_literal_number_{i}">;')
+        lines.append(f'static_assert(std::string_view{{Str{i}{{}}}} == "string_literal_number_{i}");')
+        lines.append(f'static_assert(Str{i}{{}}.size() == {len(f"string_literal_number_{i}") + 1});')
+    lines.append('int main() {}')
+    return '\n'.join(lines)
+
+
+GENERATORS = {
+    'ct2rt': gen_ct2rt,
+    'to_runtime': gen_to_runtime,
+    'aggregate_helper': gen_aggregate_helper,
+    'template_strings': gen_template_strings,
+}
+
+
+def parse_time_report(output):
+    phases = {}
+    for name, key in (('template instantiation', 'instantiation_s'),
+                      ('constant expression evaluation', 'constexpr_s')):
+        # usr, sys and wall columns, wall is taken
+        match = re.search(rf'^ {re.escape(name)}\s*:\s*[\d.]+ \(\s*\d+%\)\s*[\d.]+ \(\s*\d+%\)\s*([\d.]+)', output, re.M)
+        if match is not None:
+            phases[key] = float(match.group(1))
+    return phases
+
+
+def parse_time_trace(path):
+    with open(path) as trace_file:
+        events = json.load(trace_file).get('traceEvents', [])
+    phases = {'instantiation_s': 0.0, 'constexpr_s': 0.0, 'constexpr_evals': 0}
+    for event in events:
+        name = event.get('name', '')
+        duration = event.get('dur', 0) / 1e6
+        if name.startswith('Total '):
+            continue
+        if name.startswith('Instantiate'):
+            phases['instantiation_s'] += duration
+        elif name.startswith('EvaluateAs') or name == 'ConstantEvaluate':
+            phases['constexpr_s'] += duration
+            phases['constexpr_evals'] += 1
+    return phases
+
+
+def compile_once(cxx, flags, source, workdir):
+    src_path = os.path.join(workdir, 'bench.cpp')
+    obj_path = os.path.join(workdir, 'bench.o')
+    with open(src_path, 'w') as src_file:
+        src_file.write(source)
+
+    is_clang = 'clang' in os.path.basename(cxx)
+    cmd = [cxx, *flags, f'-I{REPO_DIR}', '-c', src_path, '-o', obj_path]
+    cmd.append('-ftime-trace' if is_clang else '-ftime-report')
+
+    # wait4 gives resource usage of exactly this compiler process
+    with tempfile.TemporaryFile(mode='w+') as stderr_file:
+        start = time.perf_counter()
+        proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL, stderr=stderr_file)
+        _, status, rusage = os.wait4(proc.pid, 0)
+        wall = time.perf_counter() - start
+        stderr_file.seek(0)
+        stderr = stderr_file.read()
+
+    result = {
+        'wall_s': wall,
+        # ru_maxrss is in kilobytes on Linux
+        'peak_mb': rusage.ru_maxrss / 1024,
+        'ok': os.waitstatus_to_exitcode(status) == 0,
+    }
+    if is_clang:
+        trace_path = os.path.splitext(obj_path)[0] + '.json'
+        if os.path.exists(trace_path):
+            result.update(parse_time_trace(trace_path))
+    else:
+        result.update(parse_time_report(stderr))
+    if not result['ok']:
+        result['error'] = next((line for line in stderr.splitlines() if 'error' in line), 'compilation failed')
+    return result
+
+
+def format_value(value, fmt):
+    return '-' if value is None else format(value, fmt)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--cxx', default=os.environ.get('CXX', 'g++'))
+    parser.add_argument('--std', default='c++23')
+    parser.add_argument('--sizes', default='1,10,50,100')
+    parser.add_argument('--only', default=','.join(GENERATORS), help='comma separated headers to benchmark')
+    parser.add_argument('--history', help='append results as JSON lines to this file')
+    args = parser.parse_args()
+
+    sizes = [int(size) for size in args.sizes.split(',')]
+    flags = [f'-std={args.std}', '-O0']
+    results = []
+
+    print('| header | size | wall s | peak MB | instantiation s | constexpr s | constexpr evals | status |')
+    print('|---|---|---|---|---|---|---|---|')
+    with tempfile.TemporaryDirectory() as workdir:
+        for header in args.only.split(','):
+            for size in sizes:
+                result = compile_once(args.cxx, flags, GENERATORS[header](size), workdir)
+                result.update({'header': header, 'size': size})
+                results.append(result)
+                print(f"| {header} | {size} | {result['wall_s']:.2f} | {result['peak_mb']:.0f} "
+                      f"| {format_value(result.get('instantiation_s'), '.2f')} "
+                      f"| {format_value(result.get('constexpr_s'), '.2f')} "
+                      f"| {format_value(result.get('constexpr_evals'), 'd')} "
+                      f"| {'ok' if result['ok'] else 'FAILED: ' + result['error'].strip()[:60]} |", flush=True)
+
+    if args.history:
+        stamp = datetime.datetime.now().isoformat(timespec='seconds')
+        with open(args.history, 'a') as history:
+            for result in results:
+                history.write(json.dumps({'time': stamp, 'cxx': args.cxx, **result}) + '\n')
+
+    return 0 if all(result['ok'] for result in results) else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -1,29 +1,35 @@
 #pragma once
 
+#include <deque>
+#include <memory>
+#include <memory_resource>
 #include <mutex>
 #include <queue>
 #include <optional>
 
-template <typename T>
+template <typename T, typename Allocator = std::allocator<T>>
 class ConcurrentQueue {
     std::mutex m_mtx;
-    std::queue<T> m_q;
+    std::queue<T, std::deque<T, Allocator>> m_q;
 
 public:
     using value_type = T;
+    using allocator_type = Allocator;
 
     ConcurrentQueue() = default;
+    explicit ConcurrentQueue(const Allocator& alloc) : m_mtx{}, m_q{alloc} {}
     ConcurrentQueue(const ConcurrentQueue& other) : m_mtx{}, m_q{other.m_q} {}
+    ConcurrentQueue(const ConcurrentQueue& other, const Allocator& alloc) : m_mtx{}, m_q{other.m_q, alloc} {}
 
     void push(T el) {
         std::lock_guard lk{m_mtx};
-        m_q.push(el);
+        m_q.push(std::move(el));
     }
 
     std::optional<T> pop() {
         std::lock_guard lk{m_mtx};
         if (m_q.size() > 0) {
-            auto ret = m_q.front();
+            auto ret = std::move(m_q.front());
             m_q.pop();
             return ret;
         }
@@ -32,3 +38,55 @@ public:
         }
     }
 };
+
+template <typename T>
+using PmrConcurrentQueue = ConcurrentQueue<T, std::pmr::polymorphic_allocator<T>>;
+
+#if defined(RUN_TESTS) || defined(RUN_BENCH)
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "test_lib.hpp"
+
+namespace concurent_queue_test {
+    // Producers push Count values each while the calling thread pops all of them
+    inline void transfer(std::size_t producers, std::size_t count) {
+        ConcurrentQueue<std::size_t> queue;
+        std::vector<std::jthread> threads;
+        for (std::size_t p = 0; p < producers; p++) {
+            threads.emplace_back([&queue, count] {
+                for (std::size_t i = 0; i < count; i++) queue.push(i);
+            });
+        }
+        std::size_t received = 0;
+        while (received < producers * count) {
+            if (auto val = queue.pop()) {
+                TESTING::do_not_optimize(*val);
+                received++;
+            }
+        }
+    }
+}  // namespace concurent_queue_test
+
+BENCH_BEGIN
+{"ConcurrentQueue", {
+    {
+        "push and pop, one thread",
+        [queue = std::make_shared<ConcurrentQueue<int>>()]{
+            queue->push(42);
+            auto val = queue->pop();
+            TESTING::do_not_optimize(val);
+        }
+    },
+    {
+        "1 producer, 10000 values",
+        []{ concurent_queue_test::transfer(1, 10000); }
+    },
+    {
+        "4 producers, 10000 values each",
+        []{ concurent_queue_test::transfer(4, 10000); }
+    }
+}}
+BENCH_END
+#endif  // RUN_TESTS || RUN_BENCH
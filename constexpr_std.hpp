@@ -79,4 +79,62 @@ constexpr double stod(const std::string& str)
     return ret;
 }
 
+#if defined(RUN_TESTS) || defined(RUN_BENCH)
+#include "test_lib.hpp"
+
+// Fractional inputs are left out of stod bench: its digit counter is static and overflows on repeated calls
+BENCH_BEGIN
+{"constexpr_std parsing", {
+    {
+        "stoi",
+        [str = std::string{"-123456789"}]{
+            TESTING::do_not_optimize(str);
+            auto val = ::stoi(str);
+            TESTING::do_not_optimize(val);
+        }
+    },
+    {
+        "std::stoi",
+        [str = std::string{"-123456789"}]{
+            TESTING::do_not_optimize(str);
+            auto val = std::stoi(str);
+            TESTING::do_not_optimize(val);
+        }
+    },
+    {
+        "stol",
+        [str = std::string{"-1234567890123456"}]{
+            TESTING::do_not_optimize(str);
+            auto val = ::stol(str);
+            TESTING::do_not_optimize(val);
+        }
+    },
+    {
+        "std::stol",
+        [str = std::string{"-1234567890123456"}]{
+            TESTING::do_not_optimize(str);
+            auto val = std::stol(str);
+            TESTING::do_not_optimize(val);
+        }
+    },
+    {
+        "stod",
+        [str = std::string{"-123456789"}]{
+            TESTING::do_not_optimize(str);
+            auto val = ::stod(str);
+            TESTING::do_not_optimize(val);
+        }
+    },
+    {
+        "std::stod",
+        [str = std::string{"-123456789"}]{
+            TESTING::do_not_optimize(str);
+            auto val = std::stod(str);
+            TESTING::do_not_optimize(val);
+        }
+    }
+}}
+BENCH_END
+#endif  // RUN_TESTS || RUN_BENCH
+
 #endif  // CONSTEXPR_STD_HPP
@@ -38,3 +38,38 @@ public:
         log(buf);
     }
 };
+
+#if defined(RUN_TESTS) || defined(RUN_BENCH)
+#include <memory>
+#include <sstream>
+
+#include "test_lib.hpp"
+
+BENCH_BEGIN
+{"Logger", {
+    {
+        "log to void_ostream",
+        []{
+            Logger<void_ostream, void_ostream> logger{void_ostream{}};
+            logger.log("request ", 42, " took ", 1.5, " ms");
+        }
+    },
+    {
+        "log to std::ostringstream",
+        [stream = std::make_shared<std::ostringstream>()]{
+            Logger<std::ostream&> logger{*stream};
+            stream->str({});
+            logger.log("request ", 42, " took ", 1.5, " ms");
+        }
+    },
+    {
+        "log_fmt to std::ostringstream",
+        [stream = std::make_shared<std::ostringstream>()]{
+            Logger<std::ostream&> logger{*stream};
+            stream->str({});
+            logger.log_fmt("request %d took %.1f ms", 42, 1.5);
+        }
+    }
+}}
+BENCH_END
+#endif  // RUN_TESTS || RUN_BENCH
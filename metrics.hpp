@@ -0,0 +1,389 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+/* Usage:
+MetricsRegistry metrics;
+auto& requests = metrics.counter("requests");
+auto& latency = metrics.histogram("latency_ns");
+
+requests.add();
+latency.record(elapsed_ns);
+
+Logger logger;
+metrics.export_to(logger);
+*/
+
+namespace detail
+{
+    constexpr std::size_t CacheLine = 64;
+
+    // Every thread gets its own shard index, threads above shard count share shards
+    inline std::size_t thread_shard() noexcept
+    {
+        static std::atomic<std::size_t> next_shard{0};
+        thread_local const std::size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed);
+        return shard;
+    }
+
+    template<typename T>
+    struct alignas(CacheLine) PaddedAtomic
+    {
+        std::atomic<T> value{0};
+    };
+}  // namespace detail
+
+// Monotonic counter, increments touch only the cache line of the calling thread's shard
+template<std::size_t Shards = 64>
+class ShardedCounter
+{
+public:
+    void add(std::uint64_t delta = 1) noexcept
+    {
+        m_shards[detail::thread_shard() % Shards].value.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    std::uint64_t read() const noexcept
+    {
+        std::uint64_t sum = 0;
+        for (const auto& shard : m_shards)
+        {
+            sum += shard.value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+private:
+    std::array<detail::PaddedAtomic<std::uint64_t>, Shards> m_shards;
+};
+
+// Current value of something, meant for rare updates so is not sharded
+class Gauge
+{
+public:
+    void set(std::int64_t value) noexcept { m_value.value.store(value, std::memory_order_relaxed); }
+    void add(std::int64_t delta) noexcept { m_value.value.fetch_add(delta, std::memory_order_relaxed); }
+    std::int64_t read() const noexcept { return m_value.value.load(std::memory_order_relaxed); }
+
+private:
+    detail::PaddedAtomic<std::int64_t> m_value;
+};
+
+/**
+ * Log bucketed histogram snapshot
+ *
+ * Every power of two range is split into 2^SubBucketBits linear buckets,
+ * so relative error of reported values is below 1 / 2^SubBucketBits.
+ */
+struct HistogramSnapshot
+{
+    static constexpr unsigned SubBucketBits = 4;
+    static constexpr std::size_t SubBuckets = std::size_t{1} << SubBucketBits;
+    static constexpr std::size_t BucketCount = (64 - SubBucketBits + 1) * SubBuckets;
+
+    static constexpr std::size_t bucket_index(std::uint64_t value) noexcept
+    {
+        if (value < SubBuckets) return static_cast<std::size_t>(value);
+        const unsigned msb = static_cast<unsigned>(std::bit_width(value)) - 1;
+        const auto mantissa = static_cast<std::size_t>(value >> (msb - SubBucketBits));
+        return (msb - SubBucketBits + 1) * SubBuckets + (mantissa - SubBuckets);
+    }
+
+    static constexpr std::uint64_t bucket_lower(std::size_t index) noexcept
+    {
+        if (index < SubBuckets) return index;
+        const std::size_t range = index / SubBuckets;
+        return std::uint64_t{index % SubBuckets + SubBuckets} << (range - 1);
+    }
+
+    static constexpr std::uint64_t bucket_upper(std::size_t index) noexcept
+    {
+        if (index < SubBuckets) return index;
+        return bucket_lower(index) + (std::uint64_t{1} << (index / SubBuckets - 1)) - 1;
+    }
+
+    std::array<std::uint64_t, BucketCount> buckets{};
+    std::uint64_t count = 0;
+
+    // Upper bound of bucket containing requested quantile, quantile in [0, 1]
+    std::uint64_t percentile(double quantile) const noexcept
+    {
+        if (count == 0) return 0;
+        auto rank = static_cast<std::uint64_t>(quantile * static_cast<double>(count - 1)) + 1;
+        for (std::size_t i = 0; i < BucketCount; i++)
+        {
+            if (buckets[i] >= rank) return bucket_upper(i);
+            rank -= buckets[i];
+        }
+        return bucket_upper(BucketCount - 1);
+    }
+
+    double mean() const noexcept
+    {
+        if (count == 0) return 0;
+        double sum = 0;
+        for (std::size_t i = 0; i < BucketCount; i++)
+        {
+            sum += static_cast<double>(buckets[i]) * (static_cast<double>(bucket_lower(i)) + static_cast<double>(bucket_upper(i))) / 2;
+        }
+        return sum / static_cast<double>(count);
+    }
+
+    std::uint64_t max() const noexcept
+    {
+        for (std::size_t i = BucketCount; i > 0; i--)
+        {
+            if (buckets[i - 1] > 0) return bucket_upper(i - 1);
+        }
+        return 0;
+    }
+};
+
+static_assert(HistogramSnapshot::bucket_index(15) == 15);
+static_assert(HistogramSnapshot::bucket_index(16) == 16);
+static_assert(HistogramSnapshot::bucket_index(33) == 32);
+static_assert(HistogramSnapshot::bucket_lower(HistogramSnapshot::bucket_index(1000)) <= 1000);
+static_assert(HistogramSnapshot::bucket_upper(HistogramSnapshot::bucket_index(1000)) >= 1000);
+static_assert(HistogramSnapshot::bucket_index(UINT64_MAX) == HistogramSnapshot::BucketCount - 1);
+
+// Latency histogram, recording is one relaxed increment in the calling thread's shard
+template<std::size_t Shards = 16>
+class LatencyHistogram
+{
+public:
+    void record(std::uint64_t value) noexcept
+    {
+        m_shards[detail::thread_shard() % Shards].buckets[HistogramSnapshot::bucket_index(value)]
+            .fetch_add(1, std::memory_order_relaxed);
+    }
+
+    HistogramSnapshot snapshot() const noexcept
+    {
+        HistogramSnapshot snap;
+        for (std::size_t shard = 0; shard < Shards; shard++)
+        {
+            for (std::size_t i = 0; i < HistogramSnapshot::BucketCount; i++)
+            {
+                const auto value = m_shards[shard].buckets[i].load(std::memory_order_relaxed);
+                snap.buckets[i] += value;
+                snap.count += value;
+            }
+        }
+        return snap;
+    }
+
+private:
+    struct alignas(detail::CacheLine) Shard
+    {
+        std::array<std::atomic<std::uint64_t>, HistogramSnapshot::BucketCount> buckets{};
+    };
+
+    std::unique_ptr<Shard[]> m_shards = std::make_unique<Shard[]>(Shards);
+};
+
+// Named metrics with stable addresses, lookup takes a lock so keep returned references
+class MetricsRegistry
+{
+public:
+    using Counter = ShardedCounter<>;
+    using Histogram = LatencyHistogram<>;
+
+    Counter& counter(std::string_view name) { return get(m_counters, name); }
+    Gauge& gauge(std::string_view name) { return get(m_gauges, name); }
+    Histogram& histogram(std::string_view name) { return get(m_histograms, name); }
+
+    template<typename Logger>
+    void export_to(Logger& logger) const
+    {
+        std::lock_guard lk{m_mtx};
+        for (const auto& [name, counter] : m_counters)
+        {
+            logger.log("counter ", name, ": ", counter->read());
+        }
+        for (const auto& [name, gauge] : m_gauges)
+        {
+            logger.log("gauge ", name, ": ", gauge->read());
+        }
+        for (const auto& [name, histogram] : m_histograms)
+        {
+            const auto snap = histogram->snapshot();
+            logger.log("histogram ", name, ": count ", snap.count, ", mean ", snap.mean(),
+                ", p50 ", snap.percentile(0.5), ", p99 ", snap.percentile(0.99),
+                ", p999 ", snap.percentile(0.999), ", max ", snap.max());
+        }
+    }
+
+private:
+    template<typename Metric>
+    using Storage = std::map<std::string, std::unique_ptr<Metric>, std::less<>>;
+
+    template<typename Metric>
+    Metric& get(Storage<Metric>& storage, std::string_view name)
+    {
+        std::lock_guard lk{m_mtx};
+        auto it = storage.find(name);
+        if (it == storage.end())
+        {
+            it = storage.emplace(std::string{name}, std::make_unique<Metric>()).first;
+        }
+        return *it->second;
+    }
+
+    mutable std::mutex m_mtx;
+    Storage<Counter> m_counters;
+    Storage<Gauge> m_gauges;
+    Storage<Histogram> m_histograms;
+};
+
+#if defined(RUN_TESTS) || defined(RUN_BENCH)
+#include <thread>
+#include <vector>
+
+#include "test_lib.hpp"
+
+namespace metrics_test
+{
+    // Counter every thread increments directly, the baseline sharding is compared to
+    struct SharedCounter
+    {
+        void add(std::uint64_t delta = 1) noexcept { m_value.value.fetch_add(delta, std::memory_order_relaxed); }
+        std::uint64_t read() const noexcept { return m_value.value.load(std::memory_order_relaxed); }
+
+        detail::PaddedAtomic<std::uint64_t> m_value;
+    };
+
+    constexpr std::size_t IncrementsPerThread = 10000;
+
+    // Workers are created on first run and then sleep between runs, so only wake up,
+    // increments and completion are timed, not creation and join of threads
+    template<typename Counter>
+    class ScalabilityWorkers
+    {
+    public:
+        explicit ScalabilityWorkers(std::size_t thread_count) : m_thread_count{thread_count} {}
+
+        ScalabilityWorkers(const ScalabilityWorkers&) = delete;
+        ScalabilityWorkers& operator=(const ScalabilityWorkers&) = delete;
+
+        ~ScalabilityWorkers()
+        {
+            m_stop.store(true, std::memory_order_relaxed);
+            m_generation.fetch_add(1, std::memory_order_release);
+            m_generation.notify_all();
+        }
+
+        void run()
+        {
+            if (m_threads.empty())
+            {
+                for (std::size_t t = 0; t < m_thread_count; t++)
+                {
+                    m_threads.emplace_back([this] { work(); });
+                }
+            }
+            m_done.store(0, std::memory_order_relaxed);
+            m_generation.fetch_add(1, std::memory_order_release);
+            m_generation.notify_all();
+            for (auto done = m_done.load(std::memory_order_acquire); done < m_thread_count;
+                 done = m_done.load(std::memory_order_acquire))
+            {
+                m_done.wait(done, std::memory_order_acquire);
+            }
+        }
+
+        std::uint64_t total() const noexcept { return m_counter.read(); }
+
+    private:
+        void work()
+        {
+            std::uint64_t seen = 0;
+            while (true)
+            {
+                m_generation.wait(seen, std::memory_order_acquire);
+                seen = m_generation.load(std::memory_order_acquire);
+                if (m_stop.load(std::memory_order_relaxed)) return;
+                for (std::size_t i = 0; i < IncrementsPerThread; i++) m_counter.add();
+                if (m_done.fetch_add(1, std::memory_order_release) + 1 == m_thread_count) m_done.notify_one();
+            }
+        }
+
+        const std::size_t m_thread_count;
+        Counter m_counter;
+        std::atomic<std::uint64_t> m_generation{0};
+        std::atomic<std::size_t> m_done{0};
+        std::atomic<bool> m_stop{false};
+        std::vector<std::jthread> m_threads;
+    };
+
+    template<typename Counter>
+    auto scalability_bench(std::size_t thread_count)
+    {
+        return [workers = std::make_shared<ScalabilityWorkers<Counter>>(thread_count)] {
+            workers->run();
+            auto total = workers->total();
+            TESTING::do_not_optimize(total);
+        };
+    }
+}  // namespace metrics_test
+
+TESTS_BEGIN
+{"metrics", {
+    {
+        "Sharded counter sums increments of all threads",
+        []{
+            ShardedCounter<4> counter;
+            {
+                std::vector<std::jthread> threads;
+                for (int t = 0; t < 8; t++)
+                {
+                    threads.emplace_back([&] {
+                        for (int i = 0; i < 1000; i++) counter.add();
+                    });
+                }
+            }
+            return counter.read() == 8000;
+        }
+    },
+    {
+        "Histogram percentiles are within bucket error",
+        []{
+            LatencyHistogram<2> histogram;
+            for (std::uint64_t i = 1; i <= 1000; i++) histogram.record(i);
+            const auto snap = histogram.snapshot();
+            const auto p50 = snap.percentile(0.5);
+            return snap.count == 1000 and p50 >= 500 and p50 < 500 + 500 / HistogramSnapshot::SubBuckets
+                and snap.max() >= 1000;
+        }
+    }
+}}
+TESTS_END
+
+BENCH_BEGIN
+{"metrics scalability, 10000 increments per thread", {
+    {"shared atomic, 1 thread", metrics_test::scalability_bench<metrics_test::SharedCounter>(1)},
+    {"ShardedCounter, 1 thread", metrics_test::scalability_bench<ShardedCounter<>>(1)},
+    {"shared atomic, 2 threads", metrics_test::scalability_bench<metrics_test::SharedCounter>(2)},
+    {"ShardedCounter, 2 threads", metrics_test::scalability_bench<ShardedCounter<>>(2)},
+    {"shared atomic, 4 threads", metrics_test::scalability_bench<metrics_test::SharedCounter>(4)},
+    {"ShardedCounter, 4 threads", metrics_test::scalability_bench<ShardedCounter<>>(4)},
+    {"shared atomic, 8 threads", metrics_test::scalability_bench<metrics_test::SharedCounter>(8)},
+    {"ShardedCounter, 8 threads", metrics_test::scalability_bench<ShardedCounter<>>(8)},
+    {"shared atomic, 16 threads", metrics_test::scalability_bench<metrics_test::SharedCounter>(16)},
+    {"ShardedCounter, 16 threads", metrics_test::scalability_bench<ShardedCounter<>>(16)},
+    {"shared atomic, 32 threads", metrics_test::scalability_bench<metrics_test::SharedCounter>(32)},
+    {"ShardedCounter, 32 threads", metrics_test::scalability_bench<ShardedCounter<>>(32)},
+    {"shared atomic, 64 threads", metrics_test::scalability_bench<metrics_test::SharedCounter>(64)},
+    {"ShardedCounter, 64 threads", metrics_test::scalability_bench<ShardedCounter<>>(64)}
+}}
+BENCH_END
+#endif  // RUN_TESTS || RUN_BENCH
@@ -1,13 +1,202 @@
 #pragma once
 
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+/* Usage:
+struct MetersTag : strong::Arithmetic, strong::Ordered, strong::Hashable {};
+using Meters = StrongType<double, MetersTag>;
+
+Operations are opt-in: tag inherits policies it wants to enable
+*/
+
+namespace strong {
+    // + - between values, * / by underlying value, unary -
+    struct Arithmetic {};
+    // <, <=, >, >=
+    struct Ordered {};
+    // std::hash specialization
+    struct Hashable {};
+}  // namespace strong
+
 template<typename UnderlingType, typename Tag>
 class StrongType
 {
+    template<typename Policy>
+    static constexpr bool Has = std::derived_from<Tag, Policy>;
+
 public:
-    explicit StrongType(const UnderlingType& val) : m_val{val} {}
-    UnderlingType get() const { return m_val; }
-    bool operator==(const StrongType<UnderlingType, Tag>& other) const { return this->m_val == other.m_val; }
+    using underlying_type = UnderlingType;
+    using tag_type = Tag;
+
+    constexpr StrongType() noexcept(std::is_nothrow_default_constructible_v<UnderlingType>)
+        requires std::default_initializable<UnderlingType> = default;
+    constexpr explicit StrongType(const UnderlingType& val) noexcept(std::is_nothrow_copy_constructible_v<UnderlingType>)
+        : m_val{val} {}
+    constexpr explicit StrongType(UnderlingType&& val) noexcept(std::is_nothrow_move_constructible_v<UnderlingType>)
+        : m_val{std::move(val)} {}
+
+    // Value of temporary is returned by value, so it can not dangle in range for and alike
+    constexpr const UnderlingType& get() const & noexcept { return m_val; }
+    constexpr UnderlingType get() && noexcept(std::is_nothrow_move_constructible_v<UnderlingType>)
+    {
+        return std::move(m_val);
+    }
+    constexpr UnderlingType get() const && noexcept(std::is_nothrow_copy_constructible_v<UnderlingType>)
+    {
+        return m_val;
+    }
+
+    constexpr bool operator==(const StrongType<UnderlingType, Tag>& other) const
+        noexcept(noexcept(m_val == other.m_val)) { return this->m_val == other.m_val; }
+
+    constexpr auto operator<=>(const StrongType<UnderlingType, Tag>& other) const
+        noexcept(noexcept(m_val <=> other.m_val))
+        requires Has<strong::Ordered> and std::three_way_comparable<UnderlingType>
+    {
+        return this->m_val <=> other.m_val;
+    }
+
+    constexpr StrongType& operator+=(const StrongType& other) noexcept(noexcept(m_val += other.m_val))
+        requires Has<strong::Arithmetic> { m_val += other.m_val; return *this; }
+    constexpr StrongType& operator-=(const StrongType& other) noexcept(noexcept(m_val -= other.m_val))
+        requires Has<strong::Arithmetic> { m_val -= other.m_val; return *this; }
+    constexpr StrongType& operator*=(const UnderlingType& factor) noexcept(noexcept(m_val *= factor))
+        requires Has<strong::Arithmetic> { m_val *= factor; return *this; }
+    constexpr StrongType& operator/=(const UnderlingType& factor) noexcept(noexcept(m_val /= factor))
+        requires Has<strong::Arithmetic> { m_val /= factor; return *this; }
+
+    friend constexpr StrongType operator+(StrongType lhs, const StrongType& rhs) noexcept(noexcept(lhs += rhs))
+        requires Has<strong::Arithmetic> { return lhs += rhs; }
+    friend constexpr StrongType operator-(StrongType lhs, const StrongType& rhs) noexcept(noexcept(lhs -= rhs))
+        requires Has<strong::Arithmetic> { return lhs -= rhs; }
+    friend constexpr StrongType operator*(StrongType lhs, const UnderlingType& factor) noexcept(noexcept(lhs *= factor))
+        requires Has<strong::Arithmetic> { return lhs *= factor; }
+    friend constexpr StrongType operator*(const UnderlingType& factor, StrongType rhs) noexcept(noexcept(rhs *= factor))
+        requires Has<strong::Arithmetic> { return rhs *= factor; }
+    friend constexpr StrongType operator/(StrongType lhs, const UnderlingType& factor) noexcept(noexcept(lhs /= factor))
+        requires Has<strong::Arithmetic> { return lhs /= factor; }
+    friend constexpr StrongType operator-(const StrongType& val) noexcept(noexcept(StrongType{-val.m_val}))
+        requires Has<strong::Arithmetic> { return StrongType{-val.m_val}; }
 
 private:
     UnderlingType m_val;
 };
+
+template<typename UnderlingType, typename Tag>
+    requires std::derived_from<Tag, strong::Hashable>
+struct std::hash<StrongType<UnderlingType, Tag>>
+{
+    constexpr std::size_t operator()(const StrongType<UnderlingType, Tag>& val) const
+        noexcept(noexcept(std::hash<UnderlingType>{}(val.get())))
+    {
+        return std::hash<UnderlingType>{}(val.get());
+    }
+};
+
+// View contiguous strong typed values as underlying values (e.g. for SIMD kernels)
+template<typename UnderlingType, typename Tag, std::size_t Extent>
+auto underlying_span(std::span<StrongType<UnderlingType, Tag>, Extent> vals) noexcept
+{
+    using Strong = StrongType<UnderlingType, Tag>;
+    static_assert(std::is_standard_layout_v<Strong> and sizeof(Strong) == sizeof(UnderlingType)
+        and alignof(Strong) == alignof(UnderlingType), "StrongType should have layout of underlying type");
+    return std::span<UnderlingType, Extent>{reinterpret_cast<UnderlingType*>(vals.data()), vals.size()};
+}
+
+template<typename UnderlingType, typename Tag, std::size_t Extent>
+auto underlying_span(std::span<const StrongType<UnderlingType, Tag>, Extent> vals) noexcept
+{
+    using Strong = StrongType<UnderlingType, Tag>;
+    static_assert(std::is_standard_layout_v<Strong> and sizeof(Strong) == sizeof(UnderlingType)
+        and alignof(Strong) == alignof(UnderlingType), "StrongType should have layout of underlying type");
+    return std::span<const UnderlingType, Extent>{reinterpret_cast<const UnderlingType*>(vals.data()), vals.size()};
+}
+
+#if defined(RUN_TESTS) || defined(RUN_BENCH)
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "test_lib.hpp"
+
+namespace strong_type_test {
+    struct MetersTag : strong::Arithmetic, strong::Ordered, strong::Hashable {};
+    using Meters = StrongType<double, MetersTag>;
+
+    struct NameTag {};
+    using Name = StrongType<std::string, NameTag>;
+
+    inline Name make_name() { return Name{"a name long enough to be allocated"}; }
+    inline const Name make_const_name() { return make_name(); }
+
+    // Same loop written with strong and raw types should compile to identical code
+    inline Meters total(std::span<const Meters> vals, double scale)
+    {
+        Meters sum{0.0};
+        for (const auto& val : vals) sum += val * scale;
+        return sum;
+    }
+
+    inline double total(std::span<const double> vals, double scale)
+    {
+        double sum = 0.0;
+        for (double val : vals) sum += val * scale;
+        return sum;
+    }
+}  // namespace strong_type_test
+
+TESTS_BEGIN
+{"strong_type", {
+    {
+        "Getter of temporary returns value",
+        []{
+            using namespace strong_type_test;
+            static_assert(std::same_as<decltype(make_name().get()), std::string>);
+            static_assert(std::same_as<decltype(std::declval<Name&>().get()), const std::string&>);
+            std::size_t count = 0;
+            for (char c : make_name().get()) count += c == 'a';
+            static_assert(std::same_as<decltype(make_const_name().get()), std::string>);
+            for (char c : make_const_name().get()) count += c == 'a';
+            return count == 8;
+        }
+    },
+    {
+        "Arithmetic and ordering",
+        []{
+            using namespace strong_type_test;
+            constexpr Meters a{1.5};
+            constexpr Meters b{2.5};
+            static_assert((a + b).get() == 4.0 and (b - a) * 2.0 == Meters{2.0} and -a < a);
+            return std::hash<Meters>{}(a) == std::hash<double>{}(1.5);
+        }
+    }
+}}
+TESTS_END
+
+BENCH_BEGIN
+{"strong_type", {
+    {
+        "StrongType<double> scaled sum of 1024 values",
+        [vals = std::vector<strong_type_test::Meters>(1024, strong_type_test::Meters{1.0})]{
+            TESTING::do_not_optimize(vals);
+            auto sum = strong_type_test::total(vals, 2.0);
+            TESTING::do_not_optimize(sum);
+        }
+    },
+    {
+        "double scaled sum of 1024 values",
+        [vals = std::vector<double>(1024, 1.0)]{
+            TESTING::do_not_optimize(vals);
+            auto sum = strong_type_test::total(vals, 2.0);
+            TESTING::do_not_optimize(sum);
+        }
+    }
+}}
+BENCH_END
+#endif  // RUN_TESTS || RUN_BENCH
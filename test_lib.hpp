@@ -1,10 +1,32 @@
 #ifndef TESTING_HPP
 #define TESTING_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
 #include <functional>
 #include <string>
 #include <string_view>
 #include <cstdio>
+#include <thread>
+#include <vector>
+
+#if __has_include(<linux/perf_event.h>)
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #define TESTING_HAS_PERF_EVENTS 1
+#endif
+
+#if __has_include(<sys/wait.h>)
+    #include <sys/wait.h>
+    #include <unistd.h>
+    #define TESTING_HAS_FORK 1
+#endif
 
 // Полезны для тестов
 #include <type_traits>
@@ -28,7 +50,30 @@ TESTS_BEGIN
 }}
 TESTS_END
 
-Тесты пишутся вне всех функций и классов и прогоняются при объявлении -DRUN_TESTS при компиляции
+Тесты пишутся вне всех функций и классов и прогоняются при объявлении -DRUN_TESTS при компиляции.
+Тесты регистрируются при статической инициализации и прогоняются параллельно после старта main,
+поэтому тесты с общим изменяемым состоянием следует запускать с --jobs=1
+
+
+Пример написания бенчмарка
+
+BENCH_BEGIN
+{"Sample bench suit", {
+    {
+        "Sample bench",
+        []{
+            int x = 42;
+            TESTING::do_not_optimize(x);
+        }
+    }
+}}
+BENCH_END
+
+Бенчмарки прогоняются при объявлении -DRUN_BENCH при компиляции.
+Тело бенчмарка - одна итерация, количество итераций подбирается автоматически.
+Свои величины (например, количество аллокаций за итерацию) бенчмарк сообщает через
+TESTING::bench_counter("name", value), в отчет попадает последнее значение.
+С параметром --bench-json=<файл> результаты пишутся в этот файл в формате JSON
 */
 namespace TESTING {
     int TEST_RESULT = EXIT_SUCCESS;
@@ -37,52 +82,602 @@ namespace TESTING {
 
     struct TEST_CASE {
         std::string_view name;
-        std::function<bool()> func;
+        bool(*bool_func)() = nullptr;
+        void(*void_func)() = nullptr;
 
         TEST_CASE(std::string_view test_name, bool(*test_func)())
-            : name{test_name}, func{test_func} {}
+            : name{test_name}, bool_func{test_func} {}
 
         TEST_CASE(std::string_view test_name, void(*test_func)())
-            : name{test_name}, func{[test_func]{test_func(); return true;}} {}
+            : name{test_name}, void_func{test_func} {}
 
         bool run() const {
-            return func();
+            if (bool_func != nullptr) {
+                return bool_func();
+            }
+            void_func();
+            return true;
         }
     };
 
+    struct TEST_SUIT {
+        std::string_view name;
+        std::vector<TEST_CASE> tests;
+    };
+
+    // Тесты регистрируются при статической инициализации, а прогоняются из main
+    std::vector<TEST_SUIT> TEST_REGISTRY;
+
     struct TEST_SUIT_IMPL {
         TEST_SUIT_IMPL(std::string_view suit_name, std::initializer_list<TEST_CASE> tests) {
     #ifdef RUN_TESTS
-            printf("\nTest suit: \"%s\"\n\n", suit_name.data());
-            size_t num{};
-            size_t failed_count{};
-            size_t success_count{};
+            TEST_REGISTRY.push_back({suit_name, tests});
+    #else
+            (void)suit_name;
+            (void)tests;
+    #endif  // RUN_TESTS
+        }
+    };
+
+    /*
+    Параметры командной строки:
+    --filter=<подстрока>  прогонять только тесты и бенчмарки, у которых "suit/name" содержит подстроку
+    --jobs=<N>            количество потоков для тестов, по умолчанию по числу ядер
+    --isolate             каждый тест в отдельном процессе, падение теста не роняет прогон,
+                          тесты идут последовательно, так как fork из многопоточного процесса небезопасен
+    --slowest=<N>         количество самых медленных тестов в итоговом отчете, по умолчанию 5
+    --junit=<файл>        отчет о тестах в формате JUnit XML
+    --json=<файл>         отчет о тестах в формате JSON
+    --bench-json=<файл>   результаты бенчмарков в формате JSON
+    */
+    struct TEST_OPTIONS {
+        std::string_view filter;
+        unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+        bool isolate = false;
+        std::size_t slowest = 5;
+        const char* junit_path = nullptr;
+        const char* json_path = nullptr;
+        const char* bench_json_path = nullptr;
+    };
 
-            for (const auto &test : tests) {
-                printf("%lu. %s", ++num, test.name.data());
+    TEST_OPTIONS parse_options(int argc, char** argv) {
+        TEST_OPTIONS options;
+        for (int i = 1; i < argc; i++) {
+            const std::string_view arg = argv[i];
+            const auto value = [&](std::string_view key) -> const char* {
+                return arg.starts_with(key) ? argv[i] + key.size() : nullptr;
+            };
+
+            if (auto filter = value("--filter=")) options.filter = filter;
+            else if (auto jobs = value("--jobs=")) options.jobs = std::max(1, std::atoi(jobs));
+            else if (arg == "--isolate") options.isolate = true;
+            else if (auto slowest = value("--slowest=")) options.slowest = static_cast<std::size_t>(std::max(0, std::atoi(slowest)));
+            else if (auto junit = value("--junit=")) options.junit_path = junit;
+            else if (auto json = value("--json=")) options.json_path = json;
+            else if (auto bench_json = value("--bench-json=")) options.bench_json_path = bench_json;
+            else printf("Unknown option \"%s\" ignored\n", argv[i]);
+        }
+    #ifdef TESTING_HAS_FORK
+        if (options.isolate) options.jobs = 1;
+    #endif  // TESTING_HAS_FORK
+        return options;
+    }
+
+    bool matches_filter(std::string_view filter, std::string_view suit_name, std::string_view name) {
+        if (filter.empty()) return true;
+        std::string full_name{suit_name};
+        full_name += '/';
+        full_name += name;
+        return full_name.find(filter) != std::string::npos;
+    }
+
+    struct TEST_RESULT_INFO {
+        const TEST_SUIT* suit;
+        const TEST_CASE* test;
+        bool passed = false;
+        double duration_ms = 0;
+        std::string error;
+    };
+
+    void run_test(const TEST_OPTIONS& options, TEST_RESULT_INFO& result) {
+        const auto start = std::chrono::steady_clock::now();
+    #ifdef TESTING_HAS_FORK
+        if (options.isolate) {
+            // Текст исключения передается из дочернего процесса через pipe
+            int fds[2] = {-1, -1};
+            // Иначе уже буферизованный вывод родителя напечатает и дочерний процесс
+            fflush(stdout);
+            const pid_t pid = pipe(fds) == 0 ? fork() : -1;
+            if (pid == 0) {
+                close(fds[0]);
                 bool success_status = false;
-                try
-                {
-                    success_status = test.run();
+                std::string error;
+                try {
+                    success_status = result.test->run();
+                }
+                catch(const std::exception& e) {
+                    error = e.what();
+                }
+                catch(...) {
+                    error = "Unknown exception";
+                }
+                for (std::size_t written = 0; written < error.size();) {
+                    const auto count = write(fds[1], error.data() + written, error.size() - written);
+                    if (count <= 0) break;
+                    written += static_cast<std::size_t>(count);
                 }
-                catch(...) {}
+                // _exit не сбрасывает буферы stdio, вывод теста иначе теряется
+                fflush(stdout);
+                _exit(success_status ? EXIT_SUCCESS : EXIT_FAILURE);
+            }
+
+            if (pid > 0) {
+                close(fds[1]);
+                char buf[256];
+                for (ssize_t count; (count = read(fds[0], buf, sizeof(buf))) > 0;) {
+                    result.error.append(buf, static_cast<std::size_t>(count));
+                }
+                close(fds[0]);
+            }
+            else if (fds[0] >= 0) {
+                close(fds[0]);
+                close(fds[1]);
+            }
+
+            int status = 0;
+            if (pid < 0 or waitpid(pid, &status, 0) != pid) {
+                result.error = "Failed to run isolated test";
+            }
+            else if (WIFSIGNALED(status)) {
+                result.error = "Crashed with signal " + std::to_string(WTERMSIG(status));
+            }
+            else {
+                result.passed = WIFEXITED(status) and WEXITSTATUS(status) == EXIT_SUCCESS;
+            }
+            result.duration_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            return;
+        }
+    #else
+        (void)options;
+    #endif  // TESTING_HAS_FORK
+
+        try
+        {
+            result.passed = result.test->run();
+        }
+        catch(const std::exception& e) {
+            result.error = e.what();
+        }
+        catch(...) {
+            result.error = "Unknown exception";
+        }
+        result.duration_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void write_json_string(FILE* file, std::string_view str) {
+        fputc('"', file);
+        for (char c : str) {
+            if (c == '"' or c == '\\') fputc('\\', file);
+            if (static_cast<unsigned char>(c) < 0x20) {
+                fprintf(file, "\\u%04x", c);
+                continue;
+            }
+            fputc(c, file);
+        }
+        fputc('"', file);
+    }
+
+    void write_xml_string(FILE* file, std::string_view str) {
+        for (char c : str) {
+            switch (c) {
+                case '<': fputs("&lt;", file); break;
+                case '>': fputs("&gt;", file); break;
+                case '&': fputs("&amp;", file); break;
+                case '"': fputs("&quot;", file); break;
+                default: fputc(c, file);
+            }
+        }
+    }
+
+    void write_junit_report(const char* path, const std::vector<TEST_RESULT_INFO>& results) {
+        FILE* file = fopen(path, "w");
+        if (file == nullptr) {
+            printf("Failed to open \"%s\" for JUnit report\n", path);
+            return;
+        }
 
-                if (success_status) {
-                    success_count++;
-                    puts(" -> Passed");
-                    TESTS_PASSED += 1;
+        fprintf(file, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites tests=\"%u\" failures=\"%u\">\n",
+            TESTS_PASSED + TESTS_FAILED, TESTS_FAILED);
+        for (const auto& suit : TEST_REGISTRY) {
+            std::size_t count{};
+            std::size_t failures{};
+            double duration_ms{};
+            for (const auto& result : results) {
+                if (result.suit != &suit) continue;
+                count++;
+                failures += result.passed ? 0 : 1;
+                duration_ms += result.duration_ms;
+            }
+            if (count == 0) continue;
+
+            fputs("  <testsuite name=\"", file);
+            write_xml_string(file, suit.name);
+            fprintf(file, "\" tests=\"%lu\" failures=\"%lu\" time=\"%.6f\">\n", count, failures, duration_ms / 1000);
+            for (const auto& result : results) {
+                if (result.suit != &suit) continue;
+                fputs("    <testcase classname=\"", file);
+                write_xml_string(file, suit.name);
+                fputs("\" name=\"", file);
+                write_xml_string(file, result.test->name);
+                fprintf(file, "\" time=\"%.6f\"", result.duration_ms / 1000);
+                if (result.passed) {
+                    fputs("/>\n", file);
+                    continue;
                 }
-                else {
-                    failed_count++;
-                    puts(" -> Failed");
-                    TESTS_FAILED += 1;
-                    TEST_RESULT = EXIT_FAILURE;
+                fputs(">\n      <failure message=\"", file);
+                write_xml_string(file, result.error.empty() ? "Failed" : result.error);
+                fputs("\"/>\n    </testcase>\n", file);
+            }
+            fputs("  </testsuite>\n", file);
+        }
+        fputs("</testsuites>\n", file);
+        fclose(file);
+    }
+
+    void write_json_report(const char* path, const std::vector<TEST_RESULT_INFO>& results) {
+        FILE* file = fopen(path, "w");
+        if (file == nullptr) {
+            printf("Failed to open \"%s\" for JSON report\n", path);
+            return;
+        }
+
+        fprintf(file, "{\"passed\": %u, \"failed\": %u, \"tests\": [", TESTS_PASSED, TESTS_FAILED);
+        for (std::size_t i = 0; i < results.size(); i++) {
+            const auto& result = results[i];
+            fputs(i == 0 ? "\n  {\"suit\": " : ",\n  {\"suit\": ", file);
+            write_json_string(file, result.suit->name);
+            fputs(", \"name\": ", file);
+            write_json_string(file, result.test->name);
+            fprintf(file, ", \"passed\": %s, \"duration_ms\": %.3f", result.passed ? "true" : "false", result.duration_ms);
+            if (not result.error.empty()) {
+                fputs(", \"error\": ", file);
+                write_json_string(file, result.error);
+            }
+            fputs("}", file);
+        }
+        fputs("\n]}\n", file);
+        fclose(file);
+    }
+
+    // Прогон зарегистрированных тестов на пуле потоков, результаты печатаются в порядке объявления
+    void run_tests(const TEST_OPTIONS& options) {
+        std::vector<TEST_RESULT_INFO> results;
+        for (const auto& suit : TEST_REGISTRY) {
+            for (const auto& test : suit.tests) {
+                if (matches_filter(options.filter, suit.name, test.name)) {
+                    results.push_back({&suit, &test, false, 0, {}});
                 }
             }
-            printf("\nSUMMARY for \"%s\": %lu passed and %lu failed\n\n", suit_name.data(), success_count, failed_count);
-    #endif  // RUN_TESTS
         }
+
+        // Один поток - тесты идут прямо в вызывающем потоке, с --isolate fork делается
+        // только из однопоточного процесса
+        if (options.jobs <= 1) {
+            for (auto& result : results) {
+                run_test(options, result);
+            }
+        }
+        else {
+            std::atomic<std::size_t> next{0};
+            std::vector<std::jthread> workers;
+            const auto worker_count = std::min<std::size_t>(options.jobs, results.size());
+            for (std::size_t i = 0; i < worker_count; i++) {
+                workers.emplace_back([&] {
+                    for (auto idx = next++; idx < results.size(); idx = next++) {
+                        run_test(options, results[idx]);
+                    }
+                });
+            }
+        }
+
+        const TEST_SUIT* current_suit = nullptr;
+        size_t num{};
+        size_t failed_count{};
+        size_t success_count{};
+        const auto print_suit_summary = [&] {
+            if (current_suit == nullptr) return;
+            printf("\nSUMMARY for \"%s\": %lu passed and %lu failed\n\n", current_suit->name.data(), success_count, failed_count);
+        };
+
+        for (const auto& result : results) {
+            if (result.suit != current_suit) {
+                print_suit_summary();
+                current_suit = result.suit;
+                num = failed_count = success_count = 0;
+                printf("\nTest suit: \"%s\"\n\n", current_suit->name.data());
+            }
+
+            printf("%lu. %s", ++num, result.test->name.data());
+            if (result.passed) {
+                success_count++;
+                printf(" -> Passed (%.3f ms)\n", result.duration_ms);
+                TESTS_PASSED += 1;
+            }
+            else {
+                failed_count++;
+                printf(" -> Failed (%.3f ms)", result.duration_ms);
+                if (not result.error.empty()) printf(": %s", result.error.c_str());
+                puts("");
+                TESTS_FAILED += 1;
+                TEST_RESULT = EXIT_FAILURE;
+            }
+        }
+        print_suit_summary();
+
+        if (options.slowest > 0 and not results.empty()) {
+            std::vector<const TEST_RESULT_INFO*> slowest;
+            for (const auto& result : results) {
+                slowest.push_back(&result);
+            }
+            const auto count = std::min(options.slowest, slowest.size());
+            std::partial_sort(slowest.begin(), slowest.begin() + static_cast<std::ptrdiff_t>(count), slowest.end(),
+                [](const auto* lhs, const auto* rhs) { return lhs->duration_ms > rhs->duration_ms; });
+
+            printf("Slowest %lu tests:\n", count);
+            for (std::size_t i = 0; i < count; i++) {
+                printf("%.3f ms %s/%s\n", slowest[i]->duration_ms, slowest[i]->suit->name.data(), slowest[i]->test->name.data());
+            }
+            puts("");
+        }
+
+        if (options.junit_path != nullptr) write_junit_report(options.junit_path, results);
+        if (options.json_path != nullptr) write_json_report(options.json_path, results);
+    }
+
+    // Барьеры против оптимизаций компилятора для бенчмарков
+    template <typename T>
+    void do_not_optimize(const T& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    template <typename T>
+    void do_not_optimize(T& value) {
+        asm volatile("" : "+m,r"(value) : : "memory");
+    }
+
+    void clobber() {
+        asm volatile("" : : : "memory");
+    }
+
+    constexpr std::chrono::nanoseconds BENCH_MIN_BATCH_TIME = std::chrono::milliseconds{2};
+    // Замеров достаточно, чтобы p99 не совпадал с максимумом
+    constexpr std::size_t BENCH_SAMPLES = 200;
+
+    // Аппаратные счетчики perf_event_open, недоступны без прав или вне Linux
+    struct PERF_COUNTERS {
+        static constexpr std::size_t COUNT = 3;
+        static constexpr const char* NAMES[COUNT] = {"cycles", "instructions", "cache_misses"};
+
+        int fds[COUNT] = {-1, -1, -1};
+
+        PERF_COUNTERS() {
+    #ifdef TESTING_HAS_PERF_EVENTS
+            constexpr std::uint64_t configs[COUNT] = {
+                PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES
+            };
+            for (std::size_t i = 0; i < COUNT; i++) {
+                perf_event_attr attr{};
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.size = sizeof(attr);
+                attr.config = configs[i];
+                attr.disabled = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            }
+    #endif  // TESTING_HAS_PERF_EVENTS
+        }
+
+        PERF_COUNTERS(const PERF_COUNTERS&) = delete;
+        PERF_COUNTERS& operator=(const PERF_COUNTERS&) = delete;
+
+        ~PERF_COUNTERS() {
+    #ifdef TESTING_HAS_PERF_EVENTS
+            for (int fd : fds) {
+                if (fd >= 0) close(fd);
+            }
+    #endif  // TESTING_HAS_PERF_EVENTS
+        }
+
+        bool available(std::size_t i) const {
+            return fds[i] >= 0;
+        }
+
+        void start() {
+    #ifdef TESTING_HAS_PERF_EVENTS
+            for (int fd : fds) {
+                if (fd < 0) continue;
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+    #endif  // TESTING_HAS_PERF_EVENTS
+        }
+
+        void stop() {
+    #ifdef TESTING_HAS_PERF_EVENTS
+            for (int fd : fds) {
+                if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+    #endif  // TESTING_HAS_PERF_EVENTS
+        }
+
+        std::uint64_t read_value(std::size_t i) const {
+            std::uint64_t value = 0;
+    #ifdef TESTING_HAS_PERF_EVENTS
+            if (fds[i] < 0 or ::read(fds[i], &value, sizeof(value)) != sizeof(value)) return 0;
+    #endif  // TESTING_HAS_PERF_EVENTS
+            return value;
+        }
+    };
+
+    struct BENCH_RESULT {
+        std::string suit;
+        std::string name;
+        std::size_t iterations;
+        double min_ns;
+        double median_ns;
+        double p99_ns;
+        // Значение на итерацию, отрицательное если счетчик недоступен
+        double counters[PERF_COUNTERS::COUNT];
+        std::vector<std::pair<std::string, double>> user_counters;
+    };
+
+    std::vector<BENCH_RESULT> BENCH_RESULTS;
+
+    // Величины, сообщенные текущим бенчмарком, бенчмарки идут последовательно
+    std::vector<std::pair<std::string, double>> BENCH_USER_COUNTERS;
+
+    void bench_counter(std::string_view name, double value) {
+        for (auto& [counter_name, counter_value] : BENCH_USER_COUNTERS) {
+            if (counter_name == name) {
+                counter_value = value;
+                return;
+            }
+        }
+        BENCH_USER_COUNTERS.emplace_back(std::string{name}, value);
+    }
+
+    struct BENCH_CASE {
+        std::string_view name;
+        std::function<void(std::size_t)> run_batch;
+
+        template <std::invocable F>
+        BENCH_CASE(std::string_view bench_name, F bench_func)
+            : name{bench_name}, run_batch{[bench_func](std::size_t iterations) mutable {
+                for (std::size_t i = 0; i < iterations; i++) {
+                    bench_func();
+                    clobber();
+                }
+            }} {}
+
+        std::chrono::nanoseconds time_batch(std::size_t iterations) const {
+            const auto start = std::chrono::steady_clock::now();
+            run_batch(iterations);
+            return std::chrono::steady_clock::now() - start;
+        }
+
+        BENCH_RESULT run(std::string_view suit_name) const {
+            // Прогрев и подбор количества итераций на замер
+            std::size_t iterations = 1;
+            while (time_batch(iterations) < BENCH_MIN_BATCH_TIME) {
+                iterations *= 2;
+            }
+
+            BENCH_USER_COUNTERS.clear();
+            PERF_COUNTERS counters;
+            std::vector<double> samples;
+            samples.reserve(BENCH_SAMPLES);
+
+            counters.start();
+            for (std::size_t i = 0; i < BENCH_SAMPLES; i++) {
+                samples.push_back(static_cast<double>(time_batch(iterations).count()) / static_cast<double>(iterations));
+            }
+            counters.stop();
+
+            std::sort(samples.begin(), samples.end());
+            const auto percentile = [&](std::size_t p) {
+                return samples[(samples.size() * p + 99) / 100 - 1];
+            };
+
+            BENCH_RESULT result{std::string{suit_name}, std::string{name}, iterations,
+                                samples.front(), percentile(50), percentile(99), {}, BENCH_USER_COUNTERS};
+            const double total_iterations = static_cast<double>(iterations * BENCH_SAMPLES);
+            for (std::size_t i = 0; i < PERF_COUNTERS::COUNT; i++) {
+                result.counters[i] = counters.available(i)
+                    ? static_cast<double>(counters.read_value(i)) / total_iterations
+                    : -1.0;
+            }
+            return result;
+        }
+    };
+
+    struct BENCH_SUIT {
+        std::string_view name;
+        std::vector<BENCH_CASE> benches;
     };
+
+    std::vector<BENCH_SUIT> BENCH_REGISTRY;
+
+    struct BENCH_SUIT_IMPL {
+        BENCH_SUIT_IMPL(std::string_view suit_name, std::initializer_list<BENCH_CASE> benches) {
+    #ifdef RUN_BENCH
+            BENCH_REGISTRY.push_back({suit_name, benches});
+    #else
+            (void)suit_name;
+            (void)benches;
+    #endif  // RUN_BENCH
+        }
+    };
+
+    // Бенчмарки всегда прогоняются последовательно, чтобы не мешать друг другу
+    void run_benches(const TEST_OPTIONS& options) {
+        for (const auto& suit : BENCH_REGISTRY) {
+            printf("\nBench suit: \"%s\"\n\n", suit.name.data());
+            size_t num{};
+
+            for (const auto &bench : suit.benches) {
+                if (not matches_filter(options.filter, suit.name, bench.name)) continue;
+
+                printf("%lu. %s", ++num, bench.name.data());
+                fflush(stdout);
+                const auto result = bench.run(suit.name);
+                printf(" -> min %.2f ns, median %.2f ns, p99 %.2f ns (%lu x %lu iterations)",
+                    result.min_ns, result.median_ns, result.p99_ns, BENCH_SAMPLES, result.iterations);
+                for (std::size_t i = 0; i < PERF_COUNTERS::COUNT; i++) {
+                    if (result.counters[i] >= 0) printf(", %s %.2f", PERF_COUNTERS::NAMES[i], result.counters[i]);
+                }
+                for (const auto& [counter_name, value] : result.user_counters) {
+                    printf(", %s %.2f", counter_name.c_str(), value);
+                }
+                puts("");
+                BENCH_RESULTS.push_back(result);
+            }
+        }
+    }
+
+    // Запись результатов бенчмарков в файл из параметра --bench-json
+    void write_bench_json(const TEST_OPTIONS& options) {
+        const char* path = options.bench_json_path;
+        if (path == nullptr or BENCH_RESULTS.empty()) return;
+
+        FILE* file = fopen(path, "w");
+        if (file == nullptr) {
+            printf("Failed to open \"%s\" for bench results\n", path);
+            return;
+        }
+
+        fputs("{\"benchmarks\": [", file);
+        for (std::size_t i = 0; i < BENCH_RESULTS.size(); i++) {
+            const auto& result = BENCH_RESULTS[i];
+            fputs(i == 0 ? "\n  {\"suit\": " : ",\n  {\"suit\": ", file);
+            write_json_string(file, result.suit);
+            fputs(", \"name\": ", file);
+            write_json_string(file, result.name);
+            fprintf(file, ", \"iterations\": %lu, \"min_ns\": %.3f, \"median_ns\": %.3f, \"p99_ns\": %.3f",
+                result.iterations, result.min_ns, result.median_ns, result.p99_ns);
+            for (std::size_t c = 0; c < PERF_COUNTERS::COUNT; c++) {
+                if (result.counters[c] >= 0) fprintf(file, ", \"%s\": %.3f", PERF_COUNTERS::NAMES[c], result.counters[c]);
+            }
+            for (const auto& [counter_name, value] : result.user_counters) {
+                fputs(", ", file);
+                write_json_string(file, counter_name);
+                fprintf(file, ": %.3f", value);
+            }
+            fputs("}", file);
+        }
+        fputs("\n]}\n", file);
+        fclose(file);
+    }
 }  // namespace TESTING
 
 
@@ -102,12 +697,30 @@ namespace TESTING {
     _Pragma("GCC diagnostic pop") \
     _Pragma("GCC diagnostic pop")
 
+#define BENCH_BEGIN \
+    _Pragma("GCC diagnostic push") \
+    _Pragma("GCC diagnostic ignored \"-Wold-style-cast\"") \
+    TESTING::BENCH_SUIT_IMPL CONCAT(bench, __COUNTER__)
+
+#define BENCH_END ;\
+    _Pragma("GCC diagnostic pop")
+
 
-#ifdef RUN_TESTS
+#if defined(RUN_TESTS) || defined(RUN_BENCH)
     #define TEST_MAIN main
-#endif  // RUN_TESTS
+#endif  // RUN_TESTS || RUN_BENCH
+
+int TEST_MAIN(int argc, char** argv) {
+    [[maybe_unused]] const auto options = TESTING::parse_options(argc, argv);
+
+#ifdef RUN_BENCH
+    TESTING::run_benches(options);
+    TESTING::write_bench_json(options);
+#endif  // RUN_BENCH
+
+#ifdef RUN_TESTS
+    TESTING::run_tests(options);
 
-int TEST_MAIN() {
     printf("All tests SUMMARY: ");
     if (TESTING::TEST_RESULT == EXIT_FAILURE) {
         printf("Some tests failed: %u passed, %u failed\n\n", TESTING::TESTS_PASSED, TESTING::TESTS_FAILED);
@@ -115,6 +728,7 @@ int TEST_MAIN() {
     else {
         printf("All tests passed: %u passed\n\n", TESTING::TESTS_PASSED);
     }
+#endif  // RUN_TESTS
     return TESTING::TEST_RESULT;
 }
 
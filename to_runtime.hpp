@@ -6,6 +6,7 @@
 #include <bit>          // for bit_cast
 #include <cstddef>      // for byte, size_t
 #include <cstdint>      // for uint8_t
+#include <memory>       // for allocator, make_obj_using_allocator
 #include <ranges>
 #include <span>
 #include <stdexcept>    // for runtime_error
@@ -126,9 +127,19 @@ struct CompiletimeResult {
         }
     }
 
-    template <Trivial T>
+    // Default constructs object, using allocator for allocator-aware types
+    template <typename T, typename Alloc>
+    static constexpr T makeObject(const Alloc& alloc) {
+        if constexpr (std::uses_allocator_v<T, Alloc>) {
+            return std::make_obj_using_allocator<T>(alloc);
+        } else {
+            return T{};
+        }
+    }
+
+    template <Trivial T, typename Alloc = std::allocator<std::byte>>
     static constexpr std::pair<T, std::size_t> fromBuffer(
-        std::span<const std::byte> buf) {
+        std::span<const std::byte> buf, const Alloc& = {}) {
         std::array<std::byte, sizeof(T)> bytes;
         std::size_t i = 0;
         for (std::byte byte : buf | std::ranges::views::take(sizeof(T))) {
@@ -137,43 +148,42 @@ struct CompiletimeResult {
         return {std::bit_cast<T>(bytes), sizeof(T)};
     }
 
-    template <ContainerRange T>
+    template <ContainerRange T, typename Alloc = std::allocator<std::byte>>
     static constexpr std::pair<T, std::size_t> fromBuffer(
-        std::span<const std::byte> buf) {
+        std::span<const std::byte> buf, const Alloc& alloc = {}) {
         const auto size = fromBuffer<SizeType>(buf).first;
 
-        T rng;
+        T rng = makeObject<T>(alloc);
         const auto itemsBytesRange =
             buf | std::ranges::views::drop(sizeof(SizeType));
         auto remainingSize = size;
         while (remainingSize > 0) {
             auto [item, readSize] = fromBuffer<typename T::value_type>(
                 itemsBytesRange |
-                std::ranges::views::drop(size - remainingSize));
+                std::ranges::views::drop(size - remainingSize), alloc);
             remainingSize -= readSize;
             append(rng, std::move(item));
         }
         return {std::move(rng), size + sizeof(SizeType)};
     }
 
-    template <TupleLike T>
+    template <TupleLike T, typename Alloc = std::allocator<std::byte>>
     static constexpr std::pair<T, std::size_t> fromBuffer(
-        std::span<const std::byte> buf) {
-        T tuple{};
-        const auto count = std::tuple_size_v<T>;
+        std::span<const std::byte> buf, const Alloc& alloc = {}) {
+        // Elements are built with allocator and moved in on construction, assigning them
+        // to default constructed std::array would copy them to the default resource
         std::size_t readBytes = 0;
-        std::apply(
-            [&](auto&... args) {
-                const auto eachFn = [&](auto& el) {
-                    using Type = std::decay_t<decltype(el)>;
-                    auto [obj, read] = fromBuffer<Type>(
-                        buf | std::ranges::views::drop(readBytes));
-                    readBytes += read;
-                    el = std::move(obj);
-                };
-                (eachFn(args), ...);
-            },
-            tuple);
+        const auto readElement = [&]<std::size_t I>(
+                                     std::integral_constant<std::size_t, I>) {
+            auto [obj, read] = fromBuffer<std::tuple_element_t<I, T>>(
+                buf | std::ranges::views::drop(readBytes), alloc);
+            readBytes += read;
+            return std::move(obj);
+        };
+        // Braced initializers are evaluated in order, so elements are read sequentially
+        T tuple = [&]<std::size_t... I>(std::index_sequence<I...>) {
+            return T{readElement(std::integral_constant<std::size_t, I>{})...};
+        }(std::make_index_sequence<std::tuple_size_v<T>>{});
         return {std::move(tuple), readBytes};
     }
 
@@ -220,6 +230,11 @@ struct CompiletimeResult {
     template<typename T> requires std::is_same_v<T, ReturnType>
     constexpr operator T() const { return fromBuffer<ReturnType>(buf).first; }
 
+    // Rebuilds result with allocator, T may differ from ReturnType only by allocators
+    // e.g. std::pmr::vector<std::pmr::string> for std::vector<std::string>
+    template<typename T = ReturnType, typename Alloc>
+    constexpr T materialize(const Alloc& alloc) const { return fromBuffer<T>(buf, alloc).first; }
+
     static constexpr std::size_t Size = countBytes(Callable());
     std::array<std::byte, Size> buf;
 };
@@ -0,0 +1,359 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
+#include "template_strings.hpp"
+
+/* Usage:
+void handle() {
+    TRACE_SCOPE("handle");
+    ...
+}
+
+std::ofstream file{"trace.json"};
+Tracer::write_chrome_trace(file);  // open in chrome://tracing or ui.perfetto.dev
+
+Tracing is compiled in only with -DENABLE_TRACING, otherwise TRACE_SCOPE expands to nothing
+*/
+
+struct TraceEvent {
+    // Address of template parameter object, unique for every distinct name
+    const char* name;
+    std::uint64_t start;
+    std::uint64_t end;
+};
+
+// Single producer single consumer ring of events of one thread, full ring drops new events
+class TraceRing {
+public:
+    static constexpr std::size_t Capacity = 1 << 16;
+
+    explicit TraceRing(std::uint64_t thread_id) : m_thread_id{thread_id} {}
+
+    void push(const TraceEvent& event) noexcept
+    {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) >= Capacity)
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        m_events[head % Capacity] = event;
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    template<typename Fn>
+    void consume(Fn&& fn)
+    {
+        const auto head = m_head.load(std::memory_order_acquire);
+        auto tail = m_tail.load(std::memory_order_relaxed);
+        for (; tail != head; tail++)
+        {
+            fn(m_events[tail % Capacity]);
+        }
+        m_tail.store(tail, std::memory_order_release);
+    }
+
+    std::uint64_t thread_id() const noexcept { return m_thread_id; }
+    std::uint64_t dropped() const noexcept { return m_dropped.load(std::memory_order_relaxed); }
+
+    std::atomic<bool> thread_finished{false};
+
+private:
+    std::uint64_t m_thread_id;
+    alignas(64) std::atomic<std::uint64_t> m_head{0};
+    alignas(64) std::atomic<std::uint64_t> m_tail{0};
+    std::atomic<std::uint64_t> m_dropped{0};
+    std::unique_ptr<TraceEvent[]> m_events = std::make_unique<TraceEvent[]>(Capacity);
+};
+
+class Tracer {
+public:
+    // Time stamp counter on x86, steady clock nanoseconds elsewhere
+    static std::uint64_t now() noexcept
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    // Event is dropped if ring for calling thread can not be allocated, it is retried on next event
+    static void record(const TraceEvent& event) noexcept
+    {
+        thread_local TraceRing* ring = nullptr;
+        if (ring == nullptr) [[unlikely]]
+        {
+            ring = register_thread();
+            if (ring == nullptr)
+            {
+                instance().m_unregistered_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        ring->push(event);
+    }
+
+    struct DrainedEvent {
+        TraceEvent event;
+        std::uint64_t thread_id;
+    };
+
+    // Collects events recorded by all threads so far
+    static std::vector<DrainedEvent> drain()
+    {
+        auto& self = instance();
+        std::vector<DrainedEvent> events;
+        std::lock_guard lk{self.m_mtx};
+        std::erase_if(self.m_rings, [&](const auto& ring) {
+            // Read before consuming, otherwise events pushed between consume and the read are lost
+            const bool finished = ring->thread_finished.load(std::memory_order_acquire);
+            ring->consume([&](const TraceEvent& event) {
+                events.push_back({event, ring->thread_id()});
+            });
+            return finished;
+        });
+        return events;
+    }
+
+    // Drains events and writes them in Chrome trace event format
+    static void write_chrome_trace(std::ostream& out)
+    {
+        const auto events = drain();
+        const double ticks_per_us = instance().ticks_per_us();
+        const auto origin = instance().m_origin_ticks;
+
+        const auto flags = out.flags();
+        const auto precision = out.precision(3);
+        out << std::fixed << "{\"traceEvents\":[";
+        bool first = true;
+        for (const auto& [event, thread_id] : events)
+        {
+            out << (first ? "\n" : ",\n");
+            first = false;
+            out << "{\"name\":";
+            write_json_string(out, event.name);
+            // Scopes opened before tracer was created start at origin
+            const auto start = std::max(event.start, origin);
+            const auto end = std::max(event.end, start);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread_id
+                << ",\"ts\":" << static_cast<double>(start - origin) / ticks_per_us
+                << ",\"dur\":" << static_cast<double>(end - start) / ticks_per_us << '}';
+        }
+        out << "\n]}\n";
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    // Drains events and logs count, total and max duration per scope name
+    template<typename Logger>
+    static void log_summary(Logger& logger)
+    {
+        struct Stats {
+            std::uint64_t count = 0;
+            std::uint64_t total = 0;
+            std::uint64_t max = 0;
+        };
+
+        std::unordered_map<const char*, Stats> stats;
+        for (const auto& [event, thread_id] : drain())
+        {
+            auto& s = stats[event.name];
+            const auto duration = event.end - event.start;
+            s.count++;
+            s.total += duration;
+            s.max = std::max(s.max, duration);
+        }
+
+        const double ticks_per_us = instance().ticks_per_us();
+        for (const auto& [name, s] : stats)
+        {
+            logger.log("trace ", name, ": count ", s.count,
+                ", total ", static_cast<double>(s.total) / ticks_per_us, " us",
+                ", max ", static_cast<double>(s.max) / ticks_per_us, " us");
+        }
+    }
+
+    static std::uint64_t dropped()
+    {
+        auto& self = instance();
+        std::lock_guard lk{self.m_mtx};
+        std::uint64_t count = self.m_unregistered_dropped.load(std::memory_order_relaxed);
+        for (const auto& ring : self.m_rings)
+        {
+            count += ring->dropped();
+        }
+        return count;
+    }
+
+private:
+    Tracer()
+        : m_origin_ticks{now()}, m_origin_time{std::chrono::steady_clock::now()} {}
+
+    static Tracer& instance()
+    {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    // Origin is taken during static initialization, not on first drain or first finished scope
+    static inline Tracer& s_eager_instance = instance();
+
+    static void write_json_string(std::ostream& out, std::string_view str)
+    {
+        constexpr char hex[] = "0123456789abcdef";
+        out << '"';
+        for (char c : str)
+        {
+            if (c == '"' or c == '\\') out << '\\';
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                out << "\\u00" << hex[(c >> 4) & 0xf] << hex[c & 0xf];
+                continue;
+            }
+            out << c;
+        }
+        out << '"';
+    }
+
+    // Marks ring of exited thread so that drain releases it after reading remaining events
+    struct ThreadGuard {
+        std::shared_ptr<TraceRing> ring;
+        ~ThreadGuard() { ring->thread_finished.store(true, std::memory_order_release); }
+    };
+
+    // Returns nullptr if ring or its registration can not be allocated
+    static TraceRing* register_thread() noexcept
+    {
+        auto& self = instance();
+        std::shared_ptr<TraceRing> ring;
+        try
+        {
+            ring = std::make_shared<TraceRing>(
+                static_cast<std::uint64_t>(std::hash<std::thread::id>{}(std::this_thread::get_id())));
+            std::lock_guard lk{self.m_mtx};
+            self.m_rings.push_back(ring);
+        }
+        catch (const std::bad_alloc&)
+        {
+            return nullptr;
+        }
+        thread_local ThreadGuard guard{ring};
+        return ring.get();
+    }
+
+    double ticks_per_us() const
+    {
+        const auto ticks = now() - m_origin_ticks;
+        const auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - m_origin_time);
+        return elapsed.count() > 0 ? static_cast<double>(ticks) / elapsed.count() : 1.0;
+    }
+
+    const std::uint64_t m_origin_ticks;
+    const std::chrono::steady_clock::time_point m_origin_time;
+    std::mutex m_mtx;
+    std::vector<std::shared_ptr<TraceRing>> m_rings;
+    std::atomic<std::uint64_t> m_unregistered_dropped{0};
+};
+
+template<StringLiteral Name>
+class TraceScope {
+public:
+    TraceScope() noexcept : m_start{Tracer::now()} {}
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    ~TraceScope()
+    {
+        Tracer::record({Name.c_str(), m_start, Tracer::now()});
+    }
+
+private:
+    std::uint64_t m_start;
+};
+
+#define TRACE_CONCAT_IMPL(x, y) x##y
+#define TRACE_CONCAT(x, y) TRACE_CONCAT_IMPL(x, y)
+
+#ifdef ENABLE_TRACING
+    #define TRACE_SCOPE(name) TraceScope<name> TRACE_CONCAT(trace_scope_, __COUNTER__)
+#else
+    #define TRACE_SCOPE(name)
+#endif  // ENABLE_TRACING
+
+#if defined(RUN_TESTS) || defined(RUN_BENCH)
+#include <sstream>
+
+#include "test_lib.hpp"
+
+TESTS_BEGIN
+{"trace", {
+    {
+        // One test, since tracer state is global and tests run in parallel
+        "Chrome trace keeps events of finished threads and escapes names",
+        []{
+            (void)Tracer::drain();
+            for (int i = 0; i < 8; i++)
+            {
+                std::jthread{[] {
+                    TraceScope<"quoted \"name\"\\path"> scope;
+                }};
+            }
+            std::ostringstream out;
+            Tracer::write_chrome_trace(out);
+            const auto json = out.str();
+
+            std::size_t count = 0;
+            for (auto pos = json.find(R"("name":"quoted \"name\"\\path")"); pos != std::string::npos;
+                 pos = json.find(R"("name":"quoted \"name\"\\path")", pos + 1))
+            {
+                count++;
+            }
+            return count == 8 and json.find("e+") == std::string::npos;
+        }
+    }
+}}
+TESTS_END
+
+// Ring holds 65536 events and drops new ones when full, so it is drained every half of it,
+// cost of drain is included in time of TraceScope
+BENCH_BEGIN
+{"trace", {
+    {
+        "empty scope",
+        [count = std::size_t{0}]() mutable {
+            count++;
+            TESTING::do_not_optimize(count);
+        }
+    },
+    {
+        "TraceScope<\"x\">",
+        [count = std::size_t{0}]() mutable {
+            {
+                TraceScope<"x"> scope;
+            }
+            if (++count % (TraceRing::Capacity / 2) == 0) (void)Tracer::drain();
+            TESTING::do_not_optimize(count);
+        }
+    }
+}}
+BENCH_END
+#endif  // RUN_TESTS || RUN_BENCH
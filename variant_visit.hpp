@@ -0,0 +1,396 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "overloaded.hpp"
+
+/* Usage:
+std::variant<int, std::string> v = 1;
+fast_visit(overloaded{
+    [](int) {},
+    [](const std::string&) {}
+}, v);
+
+std::vector<std::variant<int, std::string>> msgs;
+batch_visit(overloaded{...}, msgs);  // all ints first, then all strings
+*/
+
+namespace detail
+{
+    template<typename... Variants>
+    constexpr std::array<std::size_t, sizeof...(Variants)> VariantSizes =
+        {std::variant_size_v<std::remove_cvref_t<Variants>>...};
+
+    template<typename... Variants>
+    constexpr std::size_t FlatTableSize = (std::size_t{1} * ... * std::variant_size_v<std::remove_cvref_t<Variants>>);
+
+    // Index of alternative of K-th variant encoded in flat table index (last variant changes fastest)
+    template<std::size_t Flat, std::size_t K, typename... Variants>
+    consteval std::size_t alternative_index()
+    {
+        std::size_t stride = 1;
+        for (std::size_t i = K + 1; i < sizeof...(Variants); i++)
+        {
+            stride *= VariantSizes<Variants...>[i];
+        }
+        return Flat / stride % VariantSizes<Variants...>[K];
+    }
+
+    template<typename Fn, typename... Variants>
+    using VisitResult = std::invoke_result_t<Fn, decltype(std::get<0>(std::declval<Variants>()))...>;
+
+    template<std::size_t I, typename Variant>
+    constexpr decltype(auto) unchecked_get(Variant&& v) noexcept
+    {
+        if constexpr (std::is_lvalue_reference_v<Variant>)
+        {
+            return *std::get_if<I>(&v);
+        }
+        else
+        {
+            return std::move(*std::get_if<I>(&v));
+        }
+    }
+
+    template<std::size_t Flat, typename Fn, typename... Variants>
+    constexpr decltype(auto) dispatch(Fn&& fn, Variants&&... vs)
+    {
+        return [&]<std::size_t... K>(std::index_sequence<K...>) -> decltype(auto) {
+            return std::invoke(std::forward<Fn>(fn),
+                unchecked_get<alternative_index<Flat, K, Variants...>()>(std::forward<Variants>(vs))...);
+        }(std::index_sequence_for<Variants...>{});
+    }
+
+    // Whether every combination of alternatives gives the same result type, as std::visit requires
+    template<typename Fn, typename... Variants, std::size_t... Flat>
+    consteval bool same_results(std::index_sequence<Flat...>)
+    {
+        return (std::is_same_v<decltype(dispatch<Flat, Fn, Variants...>(std::declval<Fn>(), std::declval<Variants>()...)),
+            VisitResult<Fn, Variants...>> and ...);
+    }
+
+    // Up to this count of alternative combinations switch is generated instead of table,
+    // compiler turns it into a jump table or inlines handlers right into it
+    constexpr std::size_t SwitchDispatchLimit = 16;
+
+    template<typename Fn, typename... Variants>
+    constexpr VisitResult<Fn, Variants...> switch_dispatch(std::size_t flat, Fn&& fn, Variants&&... vs)
+    {
+        constexpr std::size_t Size = FlatTableSize<Variants...>;
+        static_assert(Size <= SwitchDispatchLimit);
+
+        switch (flat)
+        {
+#define VARIANT_VISIT_CASE(I) \
+            case I: \
+                if constexpr (I < Size) return dispatch<I>(std::forward<Fn>(fn), std::forward<Variants>(vs)...); \
+                [[fallthrough]];
+
+            VARIANT_VISIT_CASE(0) VARIANT_VISIT_CASE(1) VARIANT_VISIT_CASE(2) VARIANT_VISIT_CASE(3)
+            VARIANT_VISIT_CASE(4) VARIANT_VISIT_CASE(5) VARIANT_VISIT_CASE(6) VARIANT_VISIT_CASE(7)
+            VARIANT_VISIT_CASE(8) VARIANT_VISIT_CASE(9) VARIANT_VISIT_CASE(10) VARIANT_VISIT_CASE(11)
+            VARIANT_VISIT_CASE(12) VARIANT_VISIT_CASE(13) VARIANT_VISIT_CASE(14) VARIANT_VISIT_CASE(15)
+#undef VARIANT_VISIT_CASE
+            default:
+                __builtin_unreachable();
+        }
+    }
+
+    template<typename Fn, typename... Variants, std::size_t... Flat>
+    consteval auto make_dispatch_table(std::index_sequence<Flat...>)
+    {
+        using Entry = VisitResult<Fn, Variants...> (*)(Fn&&, Variants&&...);
+        return std::array<Entry, sizeof...(Flat)>{&dispatch<Flat, Fn, Variants...>...};
+    }
+
+    template<typename Fn, typename... Variants>
+    constexpr auto DispatchTable =
+        make_dispatch_table<Fn, Variants...>(std::make_index_sequence<FlatTableSize<Variants...>>{});
+
+    template<typename T>
+    constexpr bool IsVariant = false;
+
+    template<typename... Ts>
+    constexpr bool IsVariant<std::variant<Ts...>> = true;
+
+    // Positions of elements sorted by alternative, reused between calls on the same thread.
+    // Buffer is taken out while in use, so nested batch_visit from handler gets its own
+    inline std::vector<std::size_t>& batch_order_buffer()
+    {
+        thread_local std::vector<std::size_t> buffer;
+        return buffer;
+    }
+
+    template<std::size_t I, typename Fn, typename Range>
+    void run_batch(Fn& fn, Range& range, const std::size_t* first, const std::size_t* last)
+    {
+        auto it = std::ranges::begin(range);
+        for (; first != last; first++)
+        {
+            std::invoke(fn, *std::get_if<I>(&it[static_cast<std::ptrdiff_t>(*first)]));
+        }
+    }
+}  // namespace detail
+
+/**
+ * Visitation of one or several variants with single dispatch on combined index
+ *
+ * Multiple variants are encoded into one index, so visitation costs one switch or one indirect
+ * call through flat table of function pointers regardless of count of variants. Up to 16
+ * combinations of alternatives switch is used. Every handler should return the same type.
+ * Check bench of this header before replacing std::visit, single variant with many alternatives
+ * is visited no faster than with std::visit.
+ */
+template<typename Fn, typename... Variants>
+constexpr decltype(auto) fast_visit(Fn&& fn, Variants&&... vs)
+{
+    static_assert(detail::same_results<Fn&&, Variants&&...>(std::make_index_sequence<detail::FlatTableSize<Variants...>>{}),
+        "All handlers should return the same type");
+
+    if ((vs.valueless_by_exception() or ...))
+    {
+        throw std::bad_variant_access{};
+    }
+
+    std::size_t flat = 0;
+    ((flat = flat * std::variant_size_v<std::remove_cvref_t<Variants>> + vs.index()), ...);
+
+    if constexpr (detail::FlatTableSize<Variants...> <= detail::SwitchDispatchLimit)
+    {
+        return detail::switch_dispatch(flat, std::forward<Fn>(fn), std::forward<Variants>(vs)...);
+    }
+    else
+    {
+        return detail::DispatchTable<Fn&&, Variants&&...>[flat](std::forward<Fn>(fn), std::forward<Variants>(vs)...);
+    }
+}
+
+/**
+ * Visits every element of range of variants grouped by alternative
+ *
+ * Positions are counting sorted by index into one buffer reused between calls and then
+ * each handler is run over its own run, which keeps dispatch predictable. Order between
+ * elements holding different alternatives is not preserved, order within one alternative is.
+ */
+template<typename Fn, std::ranges::random_access_range Range>
+    requires detail::IsVariant<std::ranges::range_value_t<Range>>
+void batch_visit(Fn&& fn, Range&& range)
+{
+    constexpr std::size_t Alternatives = std::variant_size_v<std::ranges::range_value_t<Range>>;
+
+    std::array<std::size_t, Alternatives + 1> offsets{};
+    for (const auto& v : range)
+    {
+        if (v.valueless_by_exception())
+        {
+            throw std::bad_variant_access{};
+        }
+        offsets[v.index() + 1]++;
+    }
+    for (std::size_t i = 1; i <= Alternatives; i++)
+    {
+        offsets[i] += offsets[i - 1];
+    }
+
+    auto order = std::exchange(detail::batch_order_buffer(), {});
+    order.resize(offsets[Alternatives]);
+    auto next = offsets;
+    std::size_t pos = 0;
+    for (const auto& v : range)
+    {
+        order[next[v.index()]++] = pos++;
+    }
+
+    // Buffer is given back even if handler throws
+    struct Restore {
+        std::vector<std::size_t>& order;
+        ~Restore() { detail::batch_order_buffer() = std::move(order); }
+    } restore{order};
+
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        (detail::run_batch<I>(fn, range, order.data() + offsets[I], order.data() + offsets[I + 1]), ...);
+    }(std::make_index_sequence<Alternatives>{});
+}
+
+#if defined(RUN_TESTS) || defined(RUN_BENCH)
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "test_lib.hpp"
+
+namespace variant_visit_test
+{
+    template<std::size_t N>
+    struct Alt
+    {
+        static constexpr std::uint64_t id = N + 1;
+        std::uint64_t value;
+    };
+
+    template<typename Seq>
+    struct MakeVariant;
+
+    template<std::size_t... N>
+    struct MakeVariant<std::index_sequence<N...>>
+    {
+        using type = std::variant<Alt<N>...>;
+    };
+
+    template<std::size_t Count>
+    using Variant = typename MakeVariant<std::make_index_sequence<Count>>::type;
+
+    // Uniformly distributed alternatives, so branch on index is unpredictable
+    template<std::size_t Count>
+    std::vector<Variant<Count>> make_variants(std::size_t size)
+    {
+        constexpr auto table = []<std::size_t... N>(std::index_sequence<N...>) {
+            return std::array<Variant<Count> (*)(std::uint64_t), Count>{
+                [](std::uint64_t value) { return Variant<Count>{Alt<N>{value}}; }...};
+        }(std::make_index_sequence<Count>{});
+
+        std::mt19937_64 rng{42};
+        std::vector<Variant<Count>> vals;
+        vals.reserve(size);
+        for (std::size_t i = 0; i < size; i++)
+        {
+            vals.push_back(table[rng() % Count](i));
+        }
+        return vals;
+    }
+
+    constexpr std::size_t BenchSize = 4096;
+
+    template<std::size_t Count>
+    auto visit_bench()
+    {
+        return [vals = make_variants<Count>(BenchSize)] {
+            std::uint64_t sum = 0;
+            for (const auto& v : vals)
+            {
+                sum += std::visit([](const auto& alt) { return alt.value * alt.id; }, v);
+            }
+            TESTING::do_not_optimize(sum);
+        };
+    }
+
+    template<std::size_t Count>
+    auto fast_visit_bench()
+    {
+        return [vals = make_variants<Count>(BenchSize)] {
+            std::uint64_t sum = 0;
+            for (const auto& v : vals)
+            {
+                sum += fast_visit([](const auto& alt) { return alt.value * alt.id; }, v);
+            }
+            TESTING::do_not_optimize(sum);
+        };
+    }
+
+    // Pairs of variants visited together, handler depends on both alternatives
+    template<std::size_t Count>
+    auto visit_pairs_bench()
+    {
+        return [lhs = make_variants<Count>(BenchSize), rhs = make_variants<Count>(BenchSize + 1)] {
+            std::uint64_t sum = 0;
+            for (std::size_t i = 0; i < BenchSize; i++)
+            {
+                sum += std::visit([](const auto& l, const auto& r) { return l.value * l.id + r.id; }, lhs[i], rhs[i]);
+            }
+            TESTING::do_not_optimize(sum);
+        };
+    }
+
+    template<std::size_t Count>
+    auto fast_visit_pairs_bench()
+    {
+        return [lhs = make_variants<Count>(BenchSize), rhs = make_variants<Count>(BenchSize + 1)] {
+            std::uint64_t sum = 0;
+            for (std::size_t i = 0; i < BenchSize; i++)
+            {
+                sum += fast_visit([](const auto& l, const auto& r) { return l.value * l.id + r.id; }, lhs[i], rhs[i]);
+            }
+            TESTING::do_not_optimize(sum);
+        };
+    }
+
+    template<std::size_t Count>
+    auto batch_visit_bench()
+    {
+        return [vals = make_variants<Count>(BenchSize)] {
+            std::uint64_t sum = 0;
+            batch_visit([&](const auto& alt) { sum += alt.value * alt.id; }, vals);
+            TESTING::do_not_optimize(sum);
+        };
+    }
+}  // namespace variant_visit_test
+
+TESTS_BEGIN
+{"variant_visit", {
+    {
+        "fast_visit of several variants",
+        []{
+            std::variant<int, std::string> a = 2;
+            std::variant<char, double> b = 1.5;
+            const auto result = fast_visit(overloaded{
+                [](int x, double y) { return x * y; },
+                [](auto&&, auto&&) { return 0.0; }
+            }, a, b);
+            return result == 3.0;
+        }
+    },
+    {
+        "batch_visit keeps order within alternative",
+        []{
+            std::vector<std::variant<int, std::string>> vals{1, "a", 2, "b", 3};
+            std::string seen;
+            batch_visit(overloaded{
+                [&](int x) { seen += std::to_string(x); },
+                [&](const std::string& s) { seen += s; }
+            }, std::as_const(vals));
+            batch_visit([](auto& x) { x = x + x; }, vals);
+            return seen == "123ab" and std::get<int>(vals[2]) == 4 and std::get<std::string>(vals[3]) == "bb";
+        }
+    },
+    {
+        "Nested batch_visit",
+        []{
+            std::vector<std::variant<int, char>> outer{1, 'a', 2};
+            std::vector<std::variant<int, char>> inner{3, 'b'};
+            int count = 0;
+            batch_visit([&](auto) {
+                batch_visit([&](auto) { count++; }, inner);
+            }, outer);
+            return count == 6;
+        }
+    }
+}}
+TESTS_END
+
+BENCH_BEGIN
+{"variant_visit", {
+    {"std::visit, 4 alternatives", variant_visit_test::visit_bench<4>()},
+    {"fast_visit, 4 alternatives", variant_visit_test::fast_visit_bench<4>()},
+    {"batch_visit, 4 alternatives", variant_visit_test::batch_visit_bench<4>()},
+    {"std::visit, 16 alternatives", variant_visit_test::visit_bench<16>()},
+    {"fast_visit, 16 alternatives", variant_visit_test::fast_visit_bench<16>()},
+    {"batch_visit, 16 alternatives", variant_visit_test::batch_visit_bench<16>()},
+    {"std::visit, 64 alternatives", variant_visit_test::visit_bench<64>()},
+    {"fast_visit, 64 alternatives", variant_visit_test::fast_visit_bench<64>()},
+    {"batch_visit, 64 alternatives", variant_visit_test::batch_visit_bench<64>()},
+    {"std::visit, 2 variants of 4 alternatives", variant_visit_test::visit_pairs_bench<4>()},
+    {"fast_visit, 2 variants of 4 alternatives", variant_visit_test::fast_visit_pairs_bench<4>()},
+    {"std::visit, 2 variants of 8 alternatives", variant_visit_test::visit_pairs_bench<8>()},
+    {"fast_visit, 2 variants of 8 alternatives", variant_visit_test::fast_visit_pairs_bench<8>()},
+    {"std::visit, 2 variants of 16 alternatives", variant_visit_test::visit_pairs_bench<16>()},
+    {"fast_visit, 2 variants of 16 alternatives", variant_visit_test::fast_visit_pairs_bench<16>()}
+}}
+BENCH_END
+#endif  // RUN_TESTS || RUN_BENCH